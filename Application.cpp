@@ -1,7 +1,14 @@
 #include <iostream>
+#include <cstdlib>
+#include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include "Application.h"
 #include "BoardWindow.h"
+#include "Book.h"
+#include "Tablebases.h"
+#include "EnginePool.h"
+#include "PgnReader.h"
 #include "insist.h"
 /*
  * Application handles application-wide stuff:
@@ -18,6 +25,8 @@
 
 Application::Application (int&argc, char**argv) : QApplication (argc, argv)
 {
+  parseOptions ();
+
   /*make the global menubar*/
   menuBar = new QMenuBar (0);
 
@@ -25,6 +34,52 @@ Application::Application (int&argc, char**argv) : QApplication (argc, argv)
   createMenus ();
   setQuitLockEnabled (false);
 }
+/*
+ * pick up the engine settings from the command line. qt has already taken out the
+ * arguments it understands. anything unknown or malformed is ignored.
+ *
+ * --movetime=N   milliseconds the engine thinks about each move
+ * --hash=N       megabytes of transposition table for each board's engine
+ * --threads=N    the most threads one board's engine searches with, all of the pool by default
+ * --pool=N       threads in the pool all the boards' engines share, one per core by default
+ * --ponder=0|1   whether the engine thinks on the human's time, on by default
+ * --book=FILE    Polyglot opening book
+ * --bookkeys=FILE  a Polyglot table of random numbers to use instead of the built in one
+ * --syzygy=PATH  directories with Syzygy tablebases, separated like PATH is
+ */
+
+void Application::parseOptions ()
+{
+  moveTime = Engine::DEFAULT_MOVE_TIME;
+  hashSize = TranspositionTable::DEFAULT_SIZE;
+  threads = 0;
+  ponder = true;
+
+  QStringList args = arguments ();
+  for (int i = 1; i < args.size (); i++)
+  {
+    std::string arg = args [i].toStdString ();
+    std::string value = arg.substr (arg.find ('=') + 1);
+
+    if (arg.compare (0, 11, "--movetime=") == 0 && atoi (value.c_str ()) > 0)
+      moveTime = atoi (value.c_str ());
+    else if (arg.compare (0, 7, "--hash=") == 0 && atoi (value.c_str ()) > 0)
+      hashSize = atoi (value.c_str ());
+    else if (arg.compare (0, 10, "--threads=") == 0 && atoi (value.c_str ()) > 0)
+      threads = atoi (value.c_str ());
+    else if (arg.compare (0, 7, "--pool=") == 0 && atoi (value.c_str ()) > 0)
+      EnginePool::getShared ()->setThreadCount (atoi (value.c_str ()));
+    else if (arg.compare (0, 9, "--ponder=") == 0)
+      ponder = atoi (value.c_str ()) != 0;
+    else if (arg.compare (0, 7, "--book=") == 0)
+      book = value;
+    else if (arg.compare (0, 11, "--bookkeys=") == 0)
+      Book::loadKeys (value);
+    else if (arg.compare (0, 9, "--syzygy=") == 0)
+      Tablebases::init (value);
+  }
+}
+
 /*
  * Application is a singleton, return its global instance
  */
@@ -81,6 +136,14 @@ void Application::createActions ()
   newAction->setShortcut (QKeySequence::New);
   connect (newAction, &QAction::triggered, this, &Application::newBoard);
 
+  openAction = new QAction (tr ("&Open Game..."), this);
+  openAction->setShortcut (QKeySequence::Open);
+  connect (openAction, &QAction::triggered, this, &Application::openGame);
+
+  saveAction = new QAction (tr ("&Save Game..."), this);
+  saveAction->setShortcut (QKeySequence::Save);
+  connect (saveAction, &QAction::triggered, this, &Application::saveGame);
+
   closeAction = new QAction (tr ("&Close Game"), this);
   closeAction->setShortcut (QKeySequence::Close);
   connect (closeAction, &QAction::triggered, this, &Application::closeBoard);
@@ -103,6 +166,15 @@ void Application::createActions ()
   humanIsWhiteAction->setChecked (true);
   pauseResumeAction = new QAction (tr ("&Pause"), this);
   offerDrawAction = new QAction (tr ("&Offer Draw"), this);
+
+  setUpAction = new QAction (tr ("&Set Up Position..."), this);
+  connect (setUpAction, &QAction::triggered, this, &Application::setUpPosition);
+
+  moveTimeAction = new QAction (tr ("Engine &Move Time..."), this);
+  connect (moveTimeAction, &QAction::triggered, this, &Application::setMoveTime);
+
+  statsAction = new QAction (tr ("Search S&tatistics"), this);
+  connect (statsAction, &QAction::triggered, this, &Application::showStats);
 }
 
 /*
@@ -118,8 +190,11 @@ void Application::createMenus ()
   fileMenu = new QMenu (tr ("&File"));
 
   fileMenu->addAction (newAction);
+  fileMenu->addAction (openAction);
+  fileMenu->addAction (saveAction);
   fileMenu->addAction (closeAction);
   closeAction->setEnabled (false); //disabled until there's at least one board window up
+  saveAction->setEnabled (false);
 
   /* these will get automatically moved off the fileMenu depending on their menuRoles*/
   fileMenu->addAction (aboutAction);
@@ -130,6 +205,12 @@ void Application::createMenus ()
   gameMenu->addAction (humanIsWhiteAction);
   gameMenu->addAction (pauseResumeAction);
   gameMenu->addAction (offerDrawAction);
+  gameMenu->addAction (setUpAction);
+  gameMenu->addAction (moveTimeAction);
+  gameMenu->addAction (statsAction);
+  setUpAction->setEnabled (false);
+  moveTimeAction->setEnabled (false);
+  statsAction->setEnabled (false);
   menuBar->addMenu (gameMenu);
 }
 
@@ -139,18 +220,166 @@ void Application::createMenus ()
  * slot called to create and show a new board window
  */
 void Application::newBoard ()
+{
+  createBoard ();
+}
+
+BoardWindow*Application::createBoard ()
 {
   BoardWindow*bw = new BoardWindow (humanIsWhiteAction->isChecked ());
   bw->show ();
 
-  /*now that there's a board window, enable close and disable new.
-    we're only allowing one open window at a time right now.*/
-
+  /*now that there's a board window, enable the things that work on one*/
   closeAction->setEnabled (true);
-  newAction->setEnabled (!closeAction->isEnabled ());
+  saveAction->setEnabled (true);
+  setUpAction->setEnabled (true);
+  moveTimeAction->setEnabled (true);
+  statsAction->setEnabled (true);
 
   /*connect a slot to the board's destroyed signal so we can update some menu state*/
   connect (bw, &QWidget::destroyed, this, &Application::boardDestroyed);
+  return bw;
+}
+
+/*
+ * the board the menu commands are for: the active window if it's a board, otherwise
+ * any board there is, or 0 if there aren't any
+ */
+
+BoardWindow*Application::activeBoard ()
+{
+  BoardWindow*bw = dynamic_cast<BoardWindow*>(activeWindow ());
+  if (bw)
+    return bw;
+  std::vector<BoardWindow*>windows = boardWindows ();
+  return windows.empty () ? 0 : windows [0];
+}
+
+/*
+ * slot called from the open action. a file with more than one game in it gets a list of
+ * them to pick from. the game replaces the one on the board, if there is one.
+ */
+
+void Application::openGame ()
+{
+  QString path = QFileDialog::getOpenFileName (activeWindow (), tr ("Open Game"), QString (),
+                                               tr ("PGN files (*.pgn);;All files (*)"));
+  if (path.isEmpty ())
+    return;
+
+  PgnReader reader;
+  std::string fileName = QFile::encodeName (path).toStdString ();
+  if (!reader.open (fileName))
+  {
+    QMessageBox::warning (activeWindow (), tr ("Open Game"), tr ("Can't open %1.").arg (path));
+    return;
+  }
+
+  /*only the tags are read for the list, which is quick even for a big database*/
+  QStringList games;
+  Pgn::Game game;
+  while (games.size () < MAX_LISTED_GAMES && reader.next (game, false))
+    games << tr ("%1. %2 - %3, %4 %5").arg (games.size () + 1)
+                                      .arg (QString::fromStdString (game.getTag ("White")))
+                                      .arg (QString::fromStdString (game.getTag ("Black")))
+                                      .arg (QString::fromStdString (game.getTag ("Event")))
+                                      .arg (QString::fromStdString (game.getTag ("Date")));
+  if (games.isEmpty ())
+  {
+    QMessageBox::warning (activeWindow (), tr ("Open Game"), tr ("There are no games in %1.").arg (path));
+    return;
+  }
+
+  int index = 0;
+  if (games.size () > 1)
+  {
+    bool ok;
+    QString picked = QInputDialog::getItem (activeWindow (), tr ("Open Game"), tr ("Game:"), games, 0, false, &ok);
+    if (!ok)
+      return;
+    index = games.indexOf (picked);
+  }
+
+  reader.open (fileName);
+  for (int i = 0; i <= index; i++)
+    reader.next (game, i == index);
+
+  if (!game.error.empty ())
+    QMessageBox::warning (activeWindow (), tr ("Open Game"),
+                          tr ("The game stops at %1.").arg (QString::fromStdString (game.error)));
+
+  BoardWindow*bw = activeBoard ();
+  if (bw && QMessageBox::warning (bw, tr ("Open Game"), tr ("Replace the game on the board?"),
+                                  QMessageBox::No | QMessageBox::Yes, QMessageBox::Yes) != QMessageBox::Yes)
+    return;
+  if (!bw)
+    bw = createBoard ();
+  bw->loadGame (game);
+}
+
+/*
+ * slot called from the save action
+ */
+
+void Application::saveGame ()
+{
+  BoardWindow*bw = activeBoard ();
+  insist (bw);
+
+  QString path = QFileDialog::getSaveFileName (bw, tr ("Save Game"), QString (), tr ("PGN files (*.pgn)"));
+  if (path.isEmpty ())
+    return;
+  if (!bw->saveGame (QFile::encodeName (path).toStdString ()))
+    QMessageBox::warning (bw, tr ("Save Game"), tr ("Can't write %1.").arg (path));
+}
+
+/*
+ * slot called from the set up action. asks for a FEN, starting from the board's position,
+ * and asks again until it gets one that parses or is cancelled.
+ */
+
+void Application::setUpPosition ()
+{
+  BoardWindow*bw = activeBoard ();
+  insist (bw);
+
+  QString fen = QString::fromStdString (bw->getFen ());
+  while (true)
+  {
+    bool ok;
+    fen = QInputDialog::getText (bw, tr ("Set Up Position"), tr ("FEN:"), QLineEdit::Normal, fen, &ok);
+    if (!ok || bw->setUpPosition (fen.trimmed ().toStdString ()))
+      return;
+    QMessageBox::warning (bw, tr ("Set Up Position"), tr ("That isn't a legal FEN."));
+  }
+}
+
+/*
+ * slot called from the move time action, sets how long the active board's engine thinks
+ * per move. every board has its own.
+ */
+
+void Application::setMoveTime ()
+{
+  BoardWindow*bw = activeBoard ();
+  insist (bw);
+
+  bool ok;
+  double seconds = QInputDialog::getDouble (bw, tr ("Engine Move Time"), tr ("Seconds per move:"),
+                                            bw->getEngine ()->getMoveTime () / 1000.0, 0.1, 3600, 1, &ok);
+  if (ok)
+    bw->getEngine ()->setMoveTime ((int) (seconds * 1000));
+}
+
+/*
+ * slot called from the stats action, shows the active board's stats panel
+ */
+
+void Application::showStats ()
+{
+  BoardWindow*bw = activeBoard ();
+  insist (bw);
+  bw->showStats ();
 }
 
 /*
@@ -167,12 +396,16 @@ void Application::closeBoard ()
 }
 
 /*
- * slot called when a boardWindow is destroyed. this just enable/disables the new/close menu actions
+ * slot called when a boardWindow is destroyed. this just enables/disables the menu actions
+ * that need a board
  */
 void Application::boardDestroyed (QObject*)
 {
-  closeAction->setEnabled (activeWindow () != 0);
-  newAction->setEnabled (!closeAction->isEnabled ());
+  closeAction->setEnabled (!boardWindows ().empty ());
+  saveAction->setEnabled (closeAction->isEnabled ());
+  setUpAction->setEnabled (closeAction->isEnabled ());
+  moveTimeAction->setEnabled (closeAction->isEnabled ());
+  statsAction->setEnabled (closeAction->isEnabled ());
 }
 
 /*
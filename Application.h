@@ -19,25 +19,77 @@ class Application : public QApplication
     return menuBar;
   }
 
+  /*milliseconds the engine thinks per move, from --movetime=N*/
+  int getMoveTime ()
+  {
+    return moveTime;
+  }
+
+  /*transposition table megabytes per board, from --hash=N*/
+  int getHashSize ()
+  {
+    return hashSize;
+  }
+
+  /*the most search threads a board uses, from --threads=N, 0 for as many as the pool has*/
+  int getThreads ()
+  {
+    return threads;
+  }
+
+  /*Polyglot book every board's engine plays from, from --book=FILE, empty for none*/
+  std::string getBook ()
+  {
+    return book;
+  }
+
+  /*whether engines think on the human's time, from --ponder=0 or 1*/
+  bool getPonder ()
+  {
+    return ponder;
+  }
+
   private:
+  enum
+  {
+    MAX_LISTED_GAMES = 5000 //games offered to pick from when opening a database
+  };
+  int moveTime;
+  int hashSize;
+  int threads;
+  bool ponder;
+  std::string book;
   QMenuBar*menuBar;
   QMenu*fileMenu;
   QMenu*gameMenu;
   QAction*newAction;
+  QAction*openAction;
+  QAction*saveAction;
   QAction*closeAction;
   QAction*aboutAction;
   QAction*quitAction;
   QAction*humanIsWhiteAction;
   QAction*pauseResumeAction;
   QAction*offerDrawAction;
+  QAction*setUpAction;
+  QAction*moveTimeAction;
+  QAction*statsAction;
   void createActions ();
   void createMenus ();
+  void parseOptions ();
+  BoardWindow*createBoard ();
+  BoardWindow*activeBoard ();
 
   public:
   std::vector<BoardWindow*>boardWindows ();
 
   public slots:
   void newBoard ();
+  void openGame ();
+  void saveGame ();
+  void setUpPosition ();
+  void setMoveTime ();
+  void showStats ();
   void closeBoard ();
   void quit ();
   void about ();
@@ -0,0 +1,231 @@
+#include <mutex>
+#include "Attacks.h"
+#include "insist.h"
+
+Bitboard Attacks::knightAttacks [64];
+Bitboard Attacks::kingAttacks [64];
+Bitboard Attacks::pawnAttacks [2][64];
+Bitboard Attacks::betweenSquares [64][64];
+Bitboard Attacks::lineSquares [64][64];
+Attacks::Magic Attacks::rookMagics [64];
+Attacks::Magic Attacks::bishopMagics [64];
+Bitboard Attacks::rookTable [ROOK_TABLE_SIZE];
+Bitboard Attacks::bishopTable [BISHOP_TABLE_SIZE];
+
+/*(rank, file) steps*/
+static int rookDirections [4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static int bishopDirections [4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+/*
+ * build all the tables. this takes a few milliseconds, most of it finding the magics.
+ */
+
+void Attacks::init ()
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    initLeapers ();
+    initMagics (rookMagics, rookTable, rookDirections);
+    initMagics (bishopMagics, bishopTable, bishopDirections);
+    initLines ();
+  });
+}
+
+/*
+ * set bit (rank, file) in b if it's on the board
+ */
+
+static void addSquare (Bitboard&b, int rank, int file)
+{
+  if (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+    b |= Bitboards::bit (rank * 8 + file);
+}
+
+void Attacks::initLeapers ()
+{
+  int knightSteps [8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+  for (int square = 0; square < 64; square++)
+  {
+    int rank = square / 8;
+    int file = square % 8;
+
+    knightAttacks [square] = kingAttacks [square] = 0;
+    for (int i = 0; i < 8; i++)
+      addSquare (knightAttacks [square], rank + knightSteps [i][0], file + knightSteps [i][1]);
+
+    for (int dr = -1; dr <= 1; dr++)
+      for (int df = -1; df <= 1; df++)
+        if (dr || df)
+          addSquare (kingAttacks [square], rank + dr, file + df);
+
+    pawnAttacks [0][square] = pawnAttacks [1][square] = 0;
+    addSquare (pawnAttacks [0][square], rank + 1, file - 1);
+    addSquare (pawnAttacks [0][square], rank + 1, file + 1);
+    addSquare (pawnAttacks [1][square], rank - 1, file - 1);
+    addSquare (pawnAttacks [1][square], rank - 1, file + 1);
+  }
+}
+
+/*
+ * attacks of a slider on square, walking each direction until it falls off the board
+ * or hits something in occupied. slow, only used to fill the tables.
+ */
+
+Bitboard Attacks::slidingAttacks (int square, Bitboard occupied, int directions [4][2])
+{
+  Bitboard attacks = 0;
+
+  for (int d = 0; d < 4; d++)
+  {
+    int rank = square / 8 + directions [d][0];
+    int file = square % 8 + directions [d][1];
+
+    while (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+    {
+      Bitboard b = Bitboards::bit (rank * 8 + file);
+      attacks |= b;
+      if (occupied & b)
+        break;
+      rank += directions [d][0];
+      file += directions [d][1];
+    }
+  }
+  return attacks;
+}
+
+/*
+ * xorshift64* generator, seeded the same way every run so the magics, and so the
+ * table layout, are reproducible.
+ */
+
+class MagicRandom
+{
+  public:
+  MagicRandom (Bitboard seed) : state (seed)
+  {
+  }
+
+  Bitboard next ()
+  {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+  }
+
+  /*magics want few bits set*/
+  Bitboard sparse ()
+  {
+    return next () & next () & next ();
+  }
+
+  private:
+  Bitboard state;
+};
+
+/*
+ * fill in the magics for one kind of slider. for every square we enumerate each subset of
+ * its blocker mask (carry-rippler), work out the real attacks and then look for a
+ * magic that maps every subset to a slot without destructive collisions.
+ */
+
+void Attacks::initMagics (Magic*magics, Bitboard*table, int directions [4][2])
+{
+  Bitboard occupancies [4096];
+  Bitboard references [4096];
+#if !defined(USE_PEXT)
+  static Bitboard seeds [8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+  int epoch [4096] = {0};
+  int attempt = 0;
+#endif
+
+  Bitboard*next = table;
+
+  for (int square = 0; square < 64; square++)
+  {
+    int rank = square / 8;
+    int file = square % 8;
+
+    /*board edges don't matter as blockers unless the slider is on that edge*/
+    Bitboard edges = ((0xFFULL | 0xFF00000000000000ULL) & ~(0xFFULL << (rank * 8))) |
+                     ((0x0101010101010101ULL | 0x8080808080808080ULL) & ~(0x0101010101010101ULL << file));
+
+    Magic&m = magics [square];
+    m.mask = slidingAttacks (square, 0, directions) & ~edges;
+    m.shift = 64 - Bitboards::popCount (m.mask);
+    m.attacks = next;
+
+    int size = 0;
+    Bitboard b = 0;
+    do
+    {
+      occupancies [size] = b;
+      references [size] = slidingAttacks (square, b, directions);
+#if defined(USE_PEXT)
+      m.attacks [_pext_u64 (b, m.mask)] = references [size];
+#endif
+      size++;
+      b = (b - m.mask) & m.mask;
+    } while (b);
+
+    next += size;
+
+#if defined(USE_PEXT)
+    m.magic = 0;
+    (void) occupancies;
+#else
+    MagicRandom random (seeds [rank]);
+    for (int i = 0; i < size;)
+    {
+      do
+        m.magic = random.sparse ();
+      while (Bitboards::popCount ((m.magic * m.mask) >> 56) < 6);
+
+      /*
+       * epoch marks which table slots were written during this attempt so the table
+       * doesn't need clearing between attempts
+       */
+      attempt++;
+      for (i = 0; i < size; i++)
+      {
+        int index = m.index (occupancies [i]);
+        if (epoch [index] < attempt)
+        {
+          epoch [index] = attempt;
+          m.attacks [index] = references [i];
+        }
+        else if (m.attacks [index] != references [i])
+          break;
+      }
+    }
+#endif
+  }
+  insist (next - table == (directions == rookDirections ? ROOK_TABLE_SIZE : BISHOP_TABLE_SIZE));
+}
+
+void Attacks::initLines ()
+{
+  for (int a = 0; a < 64; a++)
+  {
+    for (int b = 0; b < 64; b++)
+    {
+      betweenSquares [a][b] = lineSquares [a][b] = 0;
+      if (a == b)
+        continue;
+
+      Bitboard ab = Bitboards::bit (a) | Bitboards::bit (b);
+      if (slidingAttacks (a, 0, rookDirections) & Bitboards::bit (b))
+      {
+        lineSquares [a][b] = (slidingAttacks (a, 0, rookDirections) & slidingAttacks (b, 0, rookDirections)) | ab;
+        betweenSquares [a][b] = slidingAttacks (a, ab, rookDirections) & slidingAttacks (b, ab, rookDirections);
+      }
+      else if (slidingAttacks (a, 0, bishopDirections) & Bitboards::bit (b))
+      {
+        lineSquares [a][b] = (slidingAttacks (a, 0, bishopDirections) & slidingAttacks (b, 0, bishopDirections)) | ab;
+        betweenSquares [a][b] = slidingAttacks (a, ab, bishopDirections) & slidingAttacks (b, ab, bishopDirections);
+      }
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef Attacks_h
+#define Attacks_h
+
+#include "Bitboard.h"
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+/*
+ * precomputed attack tables. leapers (knight, king, pawn) are a straight lookup per square,
+ * sliders (bishop, rook) use magic bitboards: the relevant blockers are masked out of the
+ * occupancy, multiplied by a per square magic number and shifted down to an index into that
+ * square's slice of a shared table. building with CONFIG+=pext swaps the multiply and shift
+ * for a single BMI2 pext instruction.
+ *
+ * init () has to be called once before anything else, it's safe to call it more than once
+ * and from more than one thread.
+ */
+
+class Attacks
+{
+  public:
+  static void init ();
+
+  static Bitboard knight (int square)
+  {
+    return knightAttacks [square];
+  }
+
+  static Bitboard king (int square)
+  {
+    return kingAttacks [square];
+  }
+
+  /*squares attacked by a pawn of color (0 white, 1 black) standing on square*/
+  static Bitboard pawn (int color, int square)
+  {
+    return pawnAttacks [color][square];
+  }
+
+  static Bitboard bishop (int square, Bitboard occupied)
+  {
+    return bishopMagics [square].attacks [bishopMagics [square].index (occupied)];
+  }
+
+  static Bitboard rook (int square, Bitboard occupied)
+  {
+    return rookMagics [square].attacks [rookMagics [square].index (occupied)];
+  }
+
+  static Bitboard queen (int square, Bitboard occupied)
+  {
+    return bishop (square, occupied) | rook (square, occupied);
+  }
+
+  /*squares strictly between a and b if they share a line, otherwise empty*/
+  static Bitboard between (int a, int b)
+  {
+    return betweenSquares [a][b];
+  }
+
+  /*the whole line through a and b, edge to edge, if they share one, otherwise empty*/
+  static Bitboard line (int a, int b)
+  {
+    return lineSquares [a][b];
+  }
+
+  private:
+  struct Magic
+  {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard*attacks;
+    int shift;
+
+    int index (Bitboard occupied)
+    {
+#if defined(USE_PEXT)
+      return (int) _pext_u64 (occupied, mask);
+#else
+      return (int) (((occupied & mask) * magic) >> shift);
+#endif
+    }
+  };
+
+  enum
+  {
+    ROOK_TABLE_SIZE = 0x19000,
+    BISHOP_TABLE_SIZE = 0x1480
+  };
+
+  static Bitboard knightAttacks [64];
+  static Bitboard kingAttacks [64];
+  static Bitboard pawnAttacks [2][64];
+  static Bitboard betweenSquares [64][64];
+  static Bitboard lineSquares [64][64];
+  static Magic rookMagics [64];
+  static Magic bishopMagics [64];
+  static Bitboard rookTable [ROOK_TABLE_SIZE];
+  static Bitboard bishopTable [BISHOP_TABLE_SIZE];
+
+  static void initLeapers ();
+  static void initMagics (Magic*magics, Bitboard*table, int directions [4][2]);
+  static void initLines ();
+  static Bitboard slidingAttacks (int square, Bitboard occupied, int directions [4][2]);
+};
+
+#endif // Attacks_h
@@ -0,0 +1,88 @@
+#ifndef Bitboard_h
+#define Bitboard_h
+
+#include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * a Bitboard is a set of squares packed into 64 bits using the same LERF
+ * mapping as PieceList, bit 0 = a1, bit 7 = h1, bit 63 = h8.
+ *
+ * bitboards are unsigned because they're used as sets of bits, not numbers: shifting a
+ * 1 into bit 63 of a signed value is undefined, and shifting it right drags the sign bit
+ * (h8) along with it.
+ *
+ * the helpers compile down to single instructions (popcnt, tzcnt/bsf) on gcc and clang,
+ * so counting and walking piece sets is O(1) per piece.
+ */
+
+typedef uint64_t Bitboard;
+
+class Bitboards
+{
+  public:
+
+  /*the bit for a single square*/
+  static Bitboard bit (int square)
+  {
+    return (Bitboard) 1 << square;
+  }
+
+  /*true if square is in the set*/
+  static bool contains (Bitboard b, int square)
+  {
+    return (b >> square) & 1;
+  }
+
+  /*number of squares in the set*/
+  static int popCount (Bitboard b)
+  {
+#if defined(_MSC_VER)
+    return (int) __popcnt64 (b);
+#else
+    return __builtin_popcountll (b);
+#endif
+  }
+
+  /*lowest square in the set. b must not be empty*/
+  static int lsb (Bitboard b)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64 (&index, b);
+    return (int) index;
+#else
+    return __builtin_ctzll (b);
+#endif
+  }
+
+  /*highest square in the set. b must not be empty*/
+  static int msb (Bitboard b)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64 (&index, b);
+    return (int) index;
+#else
+    return 63 ^ __builtin_clzll (b);
+#endif
+  }
+
+  /*remove the lowest square from the set and return it. b must not be empty*/
+  static int popLsb (Bitboard&b)
+  {
+    int square = lsb (b);
+    b &= b - 1;
+    return square;
+  }
+
+  /*true if the set has more than one square in it*/
+  static bool moreThanOne (Bitboard b)
+  {
+    return b & (b - 1);
+  }
+};
+
+#endif // Bitboard_h
@@ -1,6 +1,12 @@
+#include <cstdlib>
+#include <vector>
 #include <QPainter>
+#include <QPointer>
 #include <QPropertyAnimation>
+#include <QTimer>
+#include "MoveGenerator.h"
 #include "PieceGraphicsItem.h"
+#include "PixmapCache.h"
 #include "BoardScene.h"
 #include "insist.h"
 
@@ -12,6 +18,10 @@
  * after every move the piece is positioned in the center of its square, and it undoes any illegal move
  * the user might have made, using an animation.
  *
+ * The engine thinks on a thread of its own, through an EngineWorker, so nothing here ever waits for it.
+ * Its moves come back as signals and are animated like the user's. After it moves it ponders,
+ * searching the position after the reply it expects while the user thinks.
+ *
  * square colors taken from the site where i stole the piece icons from.
  * http:/poisson.phc.unipi.it/~monge/chess_art.php
  */
@@ -20,53 +30,50 @@
 #define LIGHT_SQUARE_RGB (200, 194, 170)
 #define MARGIN 0.1
 
-/*
- * BoardScene's constructor makes the pixmap lists. These should probably be statically
- * allocated and shared across instances of BoardScenes, but you can't allocate QPixmaps
- * statically because qt requires a GQuiApplication to be constructed before any QPixmaps are.
- */
-
-BoardScene::BoardScene (PieceList*pieceList, Engine*engine, qreal width, qreal height, QObject*parent) : QGraphicsScene (0, 0, width, height, parent),
-  plainPixmaps
-  ({
-{PieceList::wPawn,new QPixmap (":/images/pieces/wp.png")},
-{PieceList::wPawn, new QPixmap (":/images/pieces/wp.png")},
-{PieceList::bPawn, new QPixmap (":/images/pieces/bp.png")},
-{PieceList::wKnight, new QPixmap (":/images/pieces/wn.png")},
-{PieceList::bKnight, new QPixmap (":/images/pieces/bn.png")},
-{PieceList::wBishop, new QPixmap (":/images/pieces/wb.png")},
-{PieceList::bBishop, new QPixmap (":/images/pieces/bb.png")},
-{PieceList::wRook, new QPixmap (":/images/pieces/wr.png")},
-{PieceList::bRook, new QPixmap (":/images/pieces/br.png")},
-{PieceList::wQueen, new QPixmap (":/images/pieces/wq.png")},
-{PieceList::bQueen, new QPixmap (":/images/pieces/bq.png")},
-{PieceList::wKing, new QPixmap (":/images/pieces/wk.png")},
-{PieceList::bKing, new QPixmap (":/images/pieces/bk.png")}
-   }
-   ),
-  shadowPixmaps
-  ({
-{PieceList::wPawn,new QPixmap (":/images/pieces_shaded/wp.png")},
-{PieceList::wPawn, new QPixmap (":/images/pieces_shaded/wp.png")},
-{PieceList::bPawn, new QPixmap (":/images/pieces_shaded/bp.png")},
-{PieceList::wKnight, new QPixmap (":/images/pieces_shaded/wn.png")},
-{PieceList::bKnight, new QPixmap (":/images/pieces_shaded/bn.png")},
-{PieceList::wBishop, new QPixmap (":/images/pieces_shaded/wb.png")},
-{PieceList::bBishop, new QPixmap (":/images/pieces_shaded/bb.png")},
-{PieceList::wRook, new QPixmap (":/images/pieces_shaded/wr.png")},
-{PieceList::bRook, new QPixmap (":/images/pieces_shaded/br.png")},
-{PieceList::wQueen, new QPixmap (":/images/pieces_shaded/wq.png")},
-{PieceList::bQueen, new QPixmap (":/images/pieces_shaded/bq.png")},
-{PieceList::wKing, new QPixmap (":/images/pieces_shaded/wk.png")},
-{PieceList::bKing, new QPixmap (":/images/pieces_shaded/bk.png")}
-   }
-   )
+BoardScene::BoardScene (PieceList*pieceList, Engine*engine, qreal width, qreal height, QObject*parent) : QGraphicsScene (0, 0, width, height, parent)
 {
   insist (pieceList);
   insist (engine);
   this->pieceList = pieceList;
   this->engine = engine;
+  searchId = 0;
+  thinking = false;
+  pondering = false;
+  animations = 0;
+  replyWaiting = false;
+  waitingId = waitingMove = waitingReply = 0;
+  for (int i = 0; i < 64; i++)
+    pieceItems [i] = 0;
+  backgroundSide = 0;
+  backgroundWhite = true;
+  PixmapCache::addBoard ();
+
+  /*the worker lives on engineThread, its signals get queued back over to us*/
+  worker = new EngineWorker (engine);
+  worker->moveToThread (&engineThread);
+  connect (worker, &EngineWorker::bestMove, this, &BoardScene::engineMoved);
+  connect (worker, &EngineWorker::info, this, &BoardScene::engineInfo);
+  connect (worker, &EngineWorker::stats, this, &BoardScene::engineStats);
+  engineThread.start ();
+
   refreshPieces ();
+
+  /*if the human is black the engine opens, once the event loop is running*/
+  if (!engine->isHumanTurn ())
+    QMetaObject::invokeMethod (this, "startEngine", Qt::QueuedConnection);
+}
+
+/*
+ * the engine has to be done with its search before the engine and the worker go away
+ */
+
+BoardScene::~BoardScene ()
+{
+  cancelEngine ();
+  engineThread.quit ();
+  engineThread.wait ();
+  delete worker;
+  PixmapCache::removeBoard ();
 }
 
 
@@ -87,7 +94,7 @@ int BoardScene::side ()
  */
 QPointF BoardScene::boardIndexToPos (int boardIndex)
 {
-  insist (boardIndex >= 0 && boardIndex < 64);
+  hotInsist (boardIndex >= 0 && boardIndex < 64);
   int squareSize = side () / 8;
   int margin = squareSize * MARGIN;
 
@@ -128,69 +135,119 @@ int BoardScene::boardIndexFromPos (const QPointF&pos)
 
 
 /*
- * delete any existing PieceGraphicsItems, and create new ones corresponding to
- * the current state of the pieceList. this should be called whenever the scene
- * size changes or when the pieceList changes.
+ * bring the PieceGraphicsItems up to date with the pieceList. this should be called whenever the scene
+ * size changes or when the pieceList changes. only squares whose contents changed get touched: an item
+ * that no longer matches its square is first offered to a square that needs the same kind of piece (the
+ * rook when castling), and only then deleted. items are resized and moved only if they are off.
  */
 
 void BoardScene::refreshPieces ()
 {
   insist (pieceList);
 
-  /*remove all items*/
-  auto items = this->items ();
-  for (auto i = items.begin (); i != items.end (); i++)
+  /*pull out the items that don't match their square anymore*/
+  std::vector<PieceGraphicsItem*> spares;
+  for (int i = 0; i < 64; i++)
   {
-    removeItem (*i);
-    delete *i;
+    if (pieceItems [i] && pieceItems [i]->getPiece () != pieceList->getPiece (i))
+    {
+      spares.push_back (pieceItems [i]);
+      pieceItems [i] = 0;
+    }
   }
 
-  /*go through the pieceList, creating items, positioning them, and adding them to the scene*/
   int squareSize = side () / 8;
   int margin = squareSize * MARGIN;
+  int size = squareSize - 2 * margin;
 
   for (int i = 0; i < 64; i++)
   {
     PieceList::Piece piece = pieceList->getPiece (i);
-    if (piece != PieceList::None)
+    if (piece == PieceList::None)
+      continue;
+
+    PieceGraphicsItem*g = pieceItems [i];
+    if (!g)
     {
-      PieceGraphicsItem*g = new PieceGraphicsItem (squareSize - 2 * margin, i, *plainPixmaps [piece], *shadowPixmaps [piece]);
-      g->setPos (boardIndexToPos (i));
-      addItem (g); //QGraphicsScene owns item now
-      connect (g, &PieceGraphicsItem::released, this, &BoardScene::released);
+      /*reuse a spare of the same piece if there is one, otherwise make a new item*/
+      for (auto s = spares.begin (); s != spares.end (); s++)
+      {
+        if ((*s)->getPiece () == piece)
+        {
+          g = *s;
+          spares.erase (s);
+          g->setBoardIndex (i);
+          break;
+        }
+      }
+      if (!g)
+      {
+        g = new PieceGraphicsItem (size, i, piece);
+        addItem (g); //QGraphicsScene owns item now
+        connect (g, &PieceGraphicsItem::released, this, &BoardScene::released);
+      }
+      pieceItems [i] = g;
     }
+
+    g->setSize (size);
+    QPointF pos = boardIndexToPos (i);
+    if (g->pos () != pos)
+      g->setPos (pos);
   }
-}
 
+  /*whatever is left over was captured*/
+  for (auto s = spares.begin (); s != spares.end (); s++)
+  {
+    removeItem (*s);
+    delete *s;
+  }
+}
 
 /*
- * draw the chessboard's squares.
+ * move the item on from over to to, getting rid of anything it lands on. this only keeps the
+ * items in step with a move that was just made, the moved item isn't repositioned.
  */
 
-void BoardScene::drawBackground (QPainter*painter, const QRectF&)
+void BoardScene::moveItem (int from, int to)
 {
-  insist (painter);
+  hotInsist (from >= 0 && from < 64);
+  hotInsist (to >= 0 && to < 64);
 
-  /*
-   * the width & height of BoardScene might not be the same between the time the user
-   * resizes the BoardWindow and the time that we correct the size programatically to maintain
-   * a square aspect ratio. Use the smaller of these dimensions (if they are different) in
-   * the drawing code.
-   */
+  PieceGraphicsItem*g = pieceItems [from];
+  if (!g || from == to)
+    return;
 
-  int side = this->side ();
+  if (pieceItems [to])
+  {
+    removeItem (pieceItems [to]);
+    delete pieceItems [to];
+  }
+  pieceItems [to] = g;
+  pieceItems [from] = 0;
+  g->setBoardIndex (to);
+}
 
-  painter->setRenderHint (QPainter::Antialiasing, true);
 
-  QBrush squareBrushes [2] = { QBrush (QColor LIGHT_SQUARE_RGB), QBrush (QColor DARK_SQUARE_RGB)};
+/*
+ * draw the chessboard's squares into the background pixmap, for a board side pixels across
+ * seen from white's side or not.
+ */
 
+void BoardScene::renderBackground (int side, bool white)
+{
   int squareSide = side / 8;
   insist (squareSide > 0);
 
+  /*the last row and column stretch a little past side, so leave room for that*/
+  background = QPixmap (side + 4, side + 4);
+  QPainter painter (&background);
+
+  QBrush squareBrushes [2] = { QBrush (QColor LIGHT_SQUARE_RGB), QBrush (QColor DARK_SQUARE_RGB)};
+
   for (int y = 0; y < 8; y++)
   {
     int startBrush = y % 2; //what square brush the row starts on
-    if (!engine->getHumanIsWhite ()) startBrush ++; //if the board is flipped, the color pattern reverses
+    if (!white) startBrush ++; //if the board is flipped, the color pattern reverses
     for (int x = 0; x < 8; x++)
     {
       /*
@@ -203,11 +260,41 @@ void BoardScene::drawBackground (QPainter*painter, const QRectF&)
       int yoff = y == 0 ? 2 : 0;
       int xoff = x == 0 ? 2 : 0;
       int ySide = squareSide + yoff + (y == 7 ? 4 + side % 8 : 0);
-      int xSide = squareSide + xoff + (x == 7 ? 4 + side % 8 : 0);;
+      int xSide = squareSide + xoff + (x == 7 ? 4 + side % 8 : 0);
 
-      painter->fillRect (QRect (x * squareSide - xoff, y * squareSide - yoff, xSide, ySide), squareBrushes [(x + startBrush) % 2]);
+      painter.fillRect (QRect (x * squareSide - xoff, y * squareSide - yoff, xSide, ySide), squareBrushes [(x + startBrush) % 2]);
     }
   }
+
+  backgroundSide = side;
+  backgroundWhite = white;
+}
+
+/*
+ * draw the chessboard's squares. they are only really drawn when the board changes size
+ * or is flipped, otherwise the exposed part of the cached background is copied.
+ */
+
+void BoardScene::drawBackground (QPainter*painter, const QRectF&rect)
+{
+  insist (painter);
+
+  /*
+   * the width & height of BoardScene might not be the same between the time the user
+   * resizes the BoardWindow and the time that we correct the size programatically to maintain
+   * a square aspect ratio. Use the smaller of these dimensions (if they are different) in
+   * the drawing code.
+   */
+
+  int side = this->side ();
+  bool white = engine->getHumanIsWhite ();
+
+  if (background.isNull () || side != backgroundSide || white != backgroundWhite)
+    renderBackground (side, white);
+
+  QRectF exposed = rect.intersected (QRectF (background.rect ()));
+  if (!exposed.isEmpty ())
+    painter->drawPixmap (exposed, background, exposed);
 }
 
 /*
@@ -235,35 +322,295 @@ void BoardScene::released (PieceGraphicsItem*piece, const QPointF&mousePos)
   insist (newBoardIndex >= 0 && newBoardIndex < 64);
 
   /*
-   * if the move is legal, make the move in the engine, and also update the index information
-   * on the pieceList's piece.
+   * if the move is legal, the engine makes the move on the pieceList, and we
+   * update the index information on the piece.
    */
 
-  if (engine->humanMove (oldBoardIndex, newBoardIndex))
+  bool moved = engine->humanMove (oldBoardIndex, newBoardIndex);
+  if (moved)
   {
-    PieceList::Piece p = pieceList->getPiece (oldBoardIndex);
-    pieceList->setPiece (oldBoardIndex, PieceList::None);
-    pieceList->setPiece (newBoardIndex, p);
-    piece->setBoardIndex (newBoardIndex);
-    piece->setPos (boardIndexToPos (piece->getBoardIndex ()));
+    moveItem (oldBoardIndex, newBoardIndex);
+    if (pondering)
+      ponderResult (oldBoardIndex, newBoardIndex);
   }
 
   /*
    * animate the piece either to the center of its new square or back where
-   * it came from, if it was an illegal move
-  */
+   * it came from, if it was an illegal move. the engine can start on its reply
+   * straight away, the reply waits for the animation.
+   */
+
+  animatePiece (piece, piece->getBoardIndex ());
+  if (moved)
+    QMetaObject::invokeMethod (this, "startEngine", Qt::QueuedConnection);
+}
+
+/*
+ * slide piece over to the square at boardIndex, then turn its shadow off. a move can also
+ * move a rook when castling, take en passant or promote, which refreshPieces picks up once
+ * every animation is done, so it doesn't snap a piece that's still on its way.
+ *
+ * the piece can be deleted before it gets there, taken by the other side's move, so it's
+ * only held by a QPointer. the animation then stops early, and finished () only comes for
+ * one that ran to the end, so the count goes down when the animation is deleted instead.
+ */
+
+void BoardScene::animatePiece (PieceGraphicsItem*piece, int boardIndex)
+{
+  insist (piece);
 
-  QPropertyAnimation*animation = new QPropertyAnimation (piece, "pos");
+  QPointer<PieceGraphicsItem> item = piece;
+  QPropertyAnimation*animation = new QPropertyAnimation (piece, "pos", this);
   animation->setDuration (ANIMATION_DURATION);
   animation->setStartValue (piece->pos ());
-  animation->setEndValue (boardIndexToPos (piece->getBoardIndex ()));
-  animation->start (QAbstractAnimation::DeleteWhenStopped);
+  animation->setEndValue (boardIndexToPos (boardIndex));
+  animations++;
 
-  /*arrange to have the piece's shadow turned off when the animation is finished*/
-  connect (animation, &QAbstractAnimation::finished, [piece] ()
+  connect (animation, &QObject::destroyed, this, [this, item] ()
   {
-    piece->setShadow (false);
+    if (item)
+      item->setShadow (false);
+    animationDone ();
   });
+  animation->start (QAbstractAnimation::DeleteWhenStopped);
+}
+
+/*
+ * once the last animation is over, catch the pieces up with the pieceList and play the
+ * engine's move if it came while a piece was still moving
+ */
 
+void BoardScene::animationDone ()
+{
+  insist (animations > 0);
+  if (--animations > 0)
+    return;
+
+  refreshPieces ();
+  if (replyWaiting)
+  {
+    replyWaiting = false;
+    engineMoved (waitingId, waitingMove, waitingReply);
+  }
 }
 
+
+/*
+ * if the side to move has no moves, say how the game ended
+ */
+
+void BoardScene::checkGameOver ()
+{
+  MoveList moves;
+  engine->getLegalMoves (moves);
+  if (moves.getSize () == 0)
+    emit status (engine->inCheck () ? tr ("Checkmate") : tr ("Stalemate"));
+}
+
+/*
+ * slot called when it's the engine's turn. this only asks the worker to start thinking,
+ * the move comes back later through engineMoved.
+ */
+
+void BoardScene::startEngine ()
+{
+  insist (engine);
+
+  if (engine->isHumanTurn () || thinking)
+    return;
+
+  thinking = true;
+  searchId++;
+  emit status (tr ("Thinking..."));
+  QMetaObject::invokeMethod (worker, "think", Qt::QueuedConnection, Q_ARG (int, searchId), Q_ARG (PieceList, *pieceList));
+}
+
+/*
+ * make the engine move now with the best it has found so far
+ */
+
+void BoardScene::moveNow ()
+{
+  if (thinking && !pondering)
+    worker->stop (searchId);
+}
+
+/*
+ * stop the engine and throw away whatever it comes up with
+ */
+
+void BoardScene::cancelEngine ()
+{
+  if (thinking)
+  {
+    thinking = false;
+    pondering = false;
+    worker->stop (searchId);
+    searchId++;
+  }
+}
+
+/*
+ * the pieceList was changed from outside, a game was loaded. forget whatever the engine was
+ * doing, show the new position and let the engine move if it's its turn.
+ */
+
+void BoardScene::positionChanged ()
+{
+  cancelEngine ();
+  refreshPieces ();
+  emit status (QString ());
+  checkGameOver ();
+  QMetaObject::invokeMethod (this, "startEngine", Qt::QueuedConnection);
+}
+
+/*
+ * after the engine has moved, search the position after reply, the move it expects back,
+ * while the human thinks. the search doesn't come back on its own, ponderResult decides
+ * what happens to it once the human has moved.
+ */
+
+void BoardScene::startPonder (Move reply)
+{
+  if (!engine->getPonder () || reply.isNull () || thinking || !engine->isHumanTurn ())
+    return;
+
+  MoveList moves;
+  engine->getLegalMoves (moves);
+  if (!moves.contains (reply))
+    return;
+
+  PieceList position = *pieceList;
+  position.makeMove (reply);
+
+  /*nothing to ponder if the engine is going to answer from its book*/
+  if (!engine->getBookMove (position).isNull ())
+    return;
+
+  thinking = true;
+  pondering = true;
+  ponderMove = reply;
+  searchId++;
+  ponderClock.start ();
+
+  /*set here rather than on the worker's thread so the human can't move before it's set*/
+  engine->setPondering (true);
+  QMetaObject::invokeMethod (worker, "think", Qt::QueuedConnection, Q_ARG (int, searchId), Q_ARG (PieceList, position));
+}
+
+/*
+ * the human has moved from "from" to "to" while the engine was pondering. if that's the move
+ * it expected, the ponder search is already on the right position with a warm hash table, so
+ * it just carries on, and the time it already spent counts against the move time. any other
+ * move and the ponder search is thrown away.
+ */
+
+void BoardScene::ponderResult (int from, int to)
+{
+  insist (pondering);
+
+  bool hit = ponderMove.getFrom () == from && ponderMove.getTo () == to &&
+             (ponderMove.getType () != Move::Promotion || ponderMove.getPromotion () == PieceList::Queen);
+  if (!hit)
+  {
+    cancelEngine ();
+    return;
+  }
+
+  pondering = false;
+  engine->setPondering (false);
+  emit status (tr ("Thinking..."));
+
+  int left = engine->getMoveTime () - (int) ponderClock.elapsed ();
+  if (left <= 0)
+    worker->stop (searchId);
+  else
+  {
+    int id = searchId;
+    QTimer::singleShot (left, this, [this, id] ()
+    {
+      if (id == searchId && thinking)
+        worker->stop (id);
+    });
+  }
+}
+
+/*
+ * slot called with the engine's search progress. score is from the engine's side.
+ */
+
+void BoardScene::engineInfo (int id, int depth, int score, qlonglong nodes, int time, QString pv)
+{
+  if (id != searchId || !thinking)
+    return;
+
+  QString prefix = pondering ? tr ("pondering %1  ").arg (QString::fromStdString (ponderMove.toString ())) : QString ();
+  QString scoreText = std::abs (score) >= Search::MATE_IN_MAX_PLY ?
+                      tr ("mate %1").arg (score > 0 ? (Search::MATE - score + 1) / 2 : -(Search::MATE + score) / 2) :
+                      QString::number (score / 100.0, 'f', 2);
+  emit status (prefix + tr ("depth %1  score %2  %3 knodes  %4 knps  %5")
+               .arg (depth).arg (scoreText).arg (nodes / 1000).arg (time > 0 ? nodes / time : 0).arg (pv));
+}
+
+/*
+ * slot called with the counts of a search that's just finished, ponder searches included.
+ * they're passed on for the stats panel.
+ */
+
+void BoardScene::engineStats (int id, Search::Stats stats)
+{
+  if (id == searchId && thinking)
+    emit searchStats (stats);
+}
+
+/*
+ * slot called when the engine has picked its move. play it and slide the piece over. the
+ * same as with the human's moves, anything more than the one piece moving gets picked up
+ * by refreshPieces once the animation is over. then the engine ponders on reply, the move
+ * it expects back.
+ */
+
+void BoardScene::engineMoved (int id, int moveData, int replyData)
+{
+  if (id != searchId || !thinking)
+    return;
+
+  /*not while the human's piece is still landing, it could be the piece this move takes*/
+  if (animations > 0)
+  {
+    replyWaiting = true;
+    waitingId = id;
+    waitingMove = moveData;
+    waitingReply = replyData;
+    return;
+  }
+  thinking = false;
+
+  /*a ponder search only ends on its own if there was nothing to search*/
+  if (pondering)
+  {
+    pondering = false;
+    return;
+  }
+
+  Move move = Move::fromData (moveData);
+  PieceGraphicsItem*piece = move.isNull () ? 0 : pieceItems [move.getFrom ()];
+
+  if (move.isNull () || !engine->playMove (move))
+  {
+    checkGameOver ();
+    return;
+  }
+  checkGameOver ();
+  startPonder (Move::fromData (replyData));
+
+  if (!piece)
+  {
+    refreshPieces ();
+    return;
+  }
+
+  moveItem (move.getFrom (), move.getTo ());
+  piece->setShadow (true);
+  animatePiece (piece, move.getTo ());
+}
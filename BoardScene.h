@@ -1,18 +1,24 @@
 #ifndef BoardScene_h
 #define BoardScene_h
 
-#include <unordered_map>
 #include <QGraphicsScene>
+#include <QThread>
+#include <QPixmap>
+#include <QElapsedTimer>
 #include "PieceGraphicsItem.h"
 #include "PieceList.h"
 #include "Engine.h"
+#include "EngineWorker.h"
 
 class BoardScene : public QGraphicsScene
 {
   Q_OBJECT
   public:
   explicit BoardScene (PieceList*pieceList, Engine*engine, qreal width, qreal height, QObject*parent=0);
-  void refreshPieces ();
+  ~BoardScene ();
+  void moveNow ();
+  void cancelEngine ();
+  void positionChanged ();
 
   protected:
   virtual void drawBackground (QPainter*painter, const QRectF&rect);
@@ -24,15 +30,43 @@ class BoardScene : public QGraphicsScene
   };
   Engine*engine;
   PieceList*pieceList;
-  std::unordered_map <int, QPixmap*>plainPixmaps;
-  std::unordered_map <int, QPixmap*>shadowPixmaps;
+  QThread engineThread;
+  EngineWorker*worker;
+  int searchId; //id of the latest search asked for, results from any other are stale
+  bool thinking;
+  bool pondering; //the search going on is on the human's time, on the position after ponderMove
+  Move ponderMove;
+  QElapsedTimer ponderClock;
+  PieceGraphicsItem*pieceItems [64]; //the item showing each square's piece, or 0
+  int animations; //pieces still sliding into place
+  bool replyWaiting; //the engine moved while a piece was still sliding, its engineMoved is below
+  int waitingId;
+  int waitingMove;
+  int waitingReply;
+  QPixmap background; //the squares, drawn for backgroundSide and backgroundWhite
+  int backgroundSide;
+  bool backgroundWhite;
   int side ();
   int boardIndexFromPos (const QPointF&pos);
   QPointF boardIndexToPos (int boardIndex);
+  void moveItem (int from, int to);
+  void animatePiece (PieceGraphicsItem*piece, int boardIndex);
+  void animationDone ();
+  void checkGameOver ();
+  void renderBackground (int side, bool white);
+  void startPonder (Move reply);
+  void ponderResult (int from, int to);
 
   signals:
+  void status (const QString&message);
+  void searchStats (const Search::Stats&stats);
 
   public slots:
+  void refreshPieces ();
+  void startEngine ();
+  void engineMoved (int id, int move, int ponderMove);
+  void engineInfo (int id, int depth, int score, qlonglong nodes, int time, QString pv);
+  void engineStats (int id, Search::Stats stats);
   void released (PieceGraphicsItem*piece, const QPointF&mousePos);
 };
 
@@ -6,10 +6,24 @@
  * BoardView is the QGraphicsView that manages the BoardScene. It handles resize events by
  * resetting the scene's "sceneRect" and also by telling the scene to update its items to
  * take into account the new board size.
+ *
+ * redoing the scene on every resize event makes live resizing stutter, so bursts of resize events
+ * are coalesced. while the window is being resized the old scene is just scaled to fit, at most once
+ * a frame and without smoothing, and once the resizing stops the scene is redone at the new size.
  */
 
 BoardView::BoardView (QWidget*parent) : QGraphicsView (parent)
 {
+  previewing = false;
+
+  frameTimer.setSingleShot (true);
+  frameTimer.setInterval (FRAME_INTERVAL);
+  connect (&frameTimer, &QTimer::timeout, this, &BoardView::preview);
+
+  settleTimer.setSingleShot (true);
+  settleTimer.setInterval (SETTLE_DELAY);
+  connect (&settleTimer, &QTimer::timeout, this, &BoardView::settle);
+
 #if 0
   /*
    * set the background to be black, this hides that there's a 1-2 pixel
@@ -38,15 +52,60 @@ void BoardView::updateSceneRect ()
 }
 
 
+/*
+ * scale the scene as it is to the view's current size. this is the cheap version of updateSceneRect
+ * used during a live resize, pixmaps are scaled without smoothing until the resize settles.
+ */
+
+void BoardView::preview ()
+{
+  insist (scene ());
+
+  if (!previewing)
+  {
+    savedHints = renderHints ();
+    setRenderHint (QPainter::Antialiasing, false);
+    setRenderHint (QPainter::SmoothPixmapTransform, false);
+    previewing = true;
+  }
+  fitInView (scene ()->sceneRect ());
+}
+
+/*
+ * the resizing has stopped, redo the scene properly at its final size
+ */
+
+void BoardView::settle ()
+{
+  frameTimer.stop ();
+  if (previewing)
+  {
+    setRenderHints (savedHints);
+    previewing = false;
+  }
+  updateSceneRect ();
+}
+
 /*
  * override resizeEvent to make sure the QGraphicsScene
- * sceneRect matches the GraphicsView size.
+ * sceneRect matches the GraphicsView size, once the resizing
+ * settles down. until then the frame timer shows a scaled preview.
  */
 
 void BoardView::resizeEvent (QResizeEvent*event)
 {
-  updateSceneRect ();
   QGraphicsView::resizeEvent (event);
+
+  /*before the first show there is nothing to preview*/
+  if (!isVisible ())
+  {
+    updateSceneRect ();
+    return;
+  }
+
+  if (!frameTimer.isActive ())
+    frameTimer.start ();
+  settleTimer.start ();
 }
 
 /*
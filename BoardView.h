@@ -2,6 +2,7 @@
 #define BoardView_h
 
 #include <QGraphicsView>
+#include <QTimer>
 
 class BoardView : public QGraphicsView
 {
@@ -14,7 +15,18 @@ class BoardView : public QGraphicsView
   virtual void showEvent(QShowEvent*event);
 
   private:
+  enum
+  {
+    FRAME_INTERVAL = 16, //ms, at most one relayout per frame while resizing
+    SETTLE_DELAY = 150 //ms without a resize before the board is properly redrawn
+  };
+  QTimer frameTimer;
+  QTimer settleTimer;
+  QPainter::RenderHints savedHints;
+  bool previewing;
   void updateSceneRect ();
+  void preview ();
+  void settle ();
 
   signals:
 
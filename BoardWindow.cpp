@@ -1,7 +1,10 @@
+#include <fstream>
 #include <QtGui>
 #include <QAction>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QStatusBar>
+#include <QTimer>
 #include "BoardWindow.h"
 #include "Application.h"
 #include "insist.h"
@@ -15,8 +18,21 @@
 BoardWindow::BoardWindow (bool humanIsWhite, QWidget*parent) : QMainWindow (parent)
 {
   /*make a new game engine*/
-  engine = new Engine (humanIsWhite);
-
+  engine = new Engine (&pieceList, humanIsWhite);
+  engine->setMoveTime (Application::application ()->getMoveTime ());
+  engine->setHashSize (Application::application ()->getHashSize ());
+  int threads = Application::application ()->getThreads ();
+  engine->setThreads (threads > 0 ? threads : EnginePool::getShared ()->getThreadCount ());
+  engine->setPonder (Application::application ()->getPonder ());
+  if (!Application::application ()->getBook ().empty ())
+    engine->setBook (Book::open (Application::application ()->getBook ()));
+
+  game.setTag ("Event", "Casual game");
+  game.setTag ("Date", QDate::currentDate ().toString ("yyyy.MM.dd").toStdString ());
+  game.setTag ("White", humanIsWhite ? "Human" : "DrB");
+  game.setTag ("Black", humanIsWhite ? "DrB" : "Human");
+
+  squarePending = false;
   setMinimumSize (QSize (MIN_DIMENSION, MIN_DIMENSION));
   setMaximumSize (QSize (MAX_DIMENSION, MAX_DIMENSION));
 
@@ -41,10 +57,27 @@ BoardWindow::BoardWindow (bool humanIsWhite, QWidget*parent) : QMainWindow (pare
   view->setScene (scene);
   view->setRenderHints (QPainter::Antialiasing | QPainter::TextAntialiasing);
   setCentralWidget (view);
+
+  /*the engine's progress goes in the status bar*/
+  connect (scene, &BoardScene::status, this, [this] (const QString&message)
+  {
+    statusBar ()->showMessage (message);
+  });
+
+  /*and the counts from each search in the stats panel, kept up to date even while it's hidden*/
+  statsPanel = new StatsPanel (this);
+  connect (scene, &BoardScene::searchStats, statsPanel, &StatsPanel::setStats);
+}
+
+void BoardWindow::showStats ()
+{
+  statsPanel->showBeside (this);
 }
 
 BoardWindow::~BoardWindow ()
 {
+  /*the scene stops the engine's thread, that has to happen before the engine goes*/
+  delete scene;
   delete engine;
 }
 
@@ -66,17 +99,97 @@ void BoardWindow::closeEvent (QCloseEvent*event)
     event->ignore ();
 }
 
+/*
+ * play out game on the board, from its start position, and carry on from there. its tags
+ * are kept for when the game is saved again.
+ */
+
+void BoardWindow::loadGame (Pgn::Game&game)
+{
+  this->game = game;
+  if (!this->game.getStart (pieceList))
+    pieceList.reset ();
+  for (Move move : game.moves)
+    pieceList.makeMove (move);
+
+  scene->positionChanged ();
+}
+
+/*
+ * start a new game from the position in fen, keeping the players and the rest of the tags.
+ * returns false, leaving the board alone, if fen doesn't parse.
+ */
+
+bool BoardWindow::setUpPosition (std::string fen)
+{
+  PieceList position;
+  if (!position.setFen (fen))
+    return false;
+
+  Pgn::Game setUp = game;
+  setUp.moves.clear ();
+  setUp.result.clear ();
+  setUp.error.clear ();
+  setUp.setTag ("Result", "*");
+  setUp.setTag ("SetUp", "1");
+  setUp.setTag ("FEN", position.getFen ());
+  loadGame (setUp);
+  return true;
+}
+
+/*
+ * write the game so far to path as PGN. the result is from the board, unless nothing has
+ * been played since the game was loaded or last saved, when it's whatever it was then (a
+ * resignation, say). returns false if the file can't be written.
+ */
+
+bool BoardWindow::saveGame (std::string path)
+{
+  std::string loadedResult = game.result.empty () ? game.getTag ("Result") : game.result;
+  int loadedPlies = (int) game.moves.size ();
+
+  game.moves.clear ();
+  for (int ply = 0; ply < pieceList.getPly (); ply++)
+    game.moves.push_back (pieceList.getMove (ply));
+  game.result = Pgn::getResult (pieceList);
+  if (game.result == "*" && (int) game.moves.size () == loadedPlies && !loadedResult.empty ())
+    game.result = loadedResult;
+  game.setTag ("Result", game.result);
+
+  std::ofstream out (path);
+  Pgn::write (out, game);
+  out.close ();
+  return !out.fail ();
+}
+
 /*
  * override resizeEvent to make sure that the window is always square.
  * we do this by calling resize () on the widget if
- * height and width aren't the same. this will cause
- * another call to resizeEvent, eventually, but the next
- * time through the width and height will be the same
- * and there the recursion stops.
+ * height and width aren't the same. resizes come in bursts while the
+ * user drags the window edge, so the correction is queued and only done
+ * once for the whole burst, with whatever size the window ends up at.
  */
 
 void BoardWindow::resizeEvent (QResizeEvent*event)
 {
+  if (!squarePending && size ().height () != size ().width ())
+  {
+    squarePending = true;
+    QTimer::singleShot (0, this, [this] () {makeSquare ();});
+  }
+
+  QMainWindow::resizeEvent (event);
+}
+
+/*
+ * resize the window to a square. this causes another call to resizeEvent, but the
+ * width and height will be the same and there the recursion stops.
+ */
+
+void BoardWindow::makeSquare ()
+{
+  squarePending = false;
+
   QSize size = this->size ();
   if (size.height () != size.width ())
   {
@@ -86,6 +199,4 @@ void BoardWindow::resizeEvent (QResizeEvent*event)
       size.setHeight (size.width ());
     resize (size);
   }
-
-  QMainWindow::resizeEvent (event);
 }
@@ -5,6 +5,8 @@
 #include <QGraphicsView>
 #include "BoardScene.h"
 #include "BoardView.h"
+#include "StatsPanel.h"
+#include "Pgn.h"
 
 class BoardWindow : public QMainWindow
 {
@@ -14,6 +16,20 @@ class BoardWindow : public QMainWindow
   BoardWindow (bool humanIsWhite, QWidget*parent=0);
   ~BoardWindow ();
   bool confirmClose ();
+  void loadGame (Pgn::Game&game);
+  bool saveGame (std::string path);
+  bool setUpPosition (std::string fen);
+  void showStats ();
+
+  Engine*getEngine ()
+  {
+    return engine;
+  }
+
+  std::string getFen ()
+  {
+    return pieceList.getFen ();
+  }
 
   private:
   enum
@@ -24,7 +40,11 @@ class BoardWindow : public QMainWindow
   Engine*engine;
   BoardView*view;
   BoardScene*scene;
+  StatsPanel*statsPanel; //hidden until asked for
   PieceList pieceList;
+  Pgn::Game game; //the tags the game is saved with, and what was loaded
+  bool squarePending;
+  void makeSquare ();
 
   protected:
   virtual void closeEvent (QCloseEvent*event);
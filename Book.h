@@ -0,0 +1,70 @@
+#ifndef Book_h
+#define Book_h
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Bitboard.h"
+#include "PieceList.h"
+#include "Move.h"
+#include "MappedFile.h"
+
+/*
+ * a Polyglot .bin opening book. the file is a sorted array of 16 byte big-endian entries:
+ * a 64 bit position key, a move, a weight and 4 bytes of learning data we don't use. the
+ * file is mapped, not read, and looked up by binary search on the key, so a book of any
+ * size opens straight away and only the pages a lookup lands on are ever read in.
+ *
+ * a book never changes once it's open, so any number of threads can probe it at once.
+ * open () hands out the same Book for the same path, so all the boards share one mapping.
+ *
+ * Polyglot keys aren't our Zobrist keys, they're made from Polyglot's own table of 781
+ * random numbers, the Random64 array in Polyglot's source, which is built in. loadKeys ()
+ * swaps in a table from a text file instead, for books made with some other one.
+ */
+
+class Book
+{
+  public:
+  struct Entry
+  {
+    Move move;
+    int weight;
+  };
+
+  static bool loadKeys (std::string path);
+  static Bitboard key (PieceList&position);
+  static std::shared_ptr<Book> open (std::string path);
+
+  void getEntries (PieceList&position, std::vector<Entry>&entries);
+  Move probe (PieceList&position, bool best = false);
+
+  long long getEntryCount ()
+  {
+    return entryCount;
+  }
+
+  private:
+  enum
+  {
+    ENTRY_SIZE = 16,
+    RANDOM_COUNT = 781,
+    RANDOM_CASTLING = 768,
+    RANDOM_EN_PASSANT = 772,
+    RANDOM_TURN = 780
+  };
+
+  MappedFile file;
+  long long entryCount;
+
+  static const Bitboard polyglotRandoms [RANDOM_COUNT];
+  static std::atomic<const Bitboard*> randoms;
+
+  Book ();
+  static Bitboard key (PieceList&position, const Bitboard*table);
+  Bitboard entryKey (long long i);
+  Move decodeMove (PieceList&position, int data);
+};
+
+#endif // Book_h
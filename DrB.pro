@@ -2,37 +2,29 @@
 #
 # Project created by QtCreator 2014-11-30T10:10:14
 #
+# the engine is a library of its own (core) with no qt in it. the app (gui)
+# and the command line tools all link it.
+#
 #-------------------------------------------------
 
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = DrB
-TEMPLATE = app
-
+TEMPLATE = subdirs
 
-SOURCES += main.cpp \
-    BoardWindow.cpp \
-    insist.cpp \
-    Application.cpp \
-    BoardScene.cpp \
-    BoardView.cpp \
-    PieceList.cpp \
-    PieceGraphicsItem.cpp \
-    Engine.cpp
+SUBDIRS = core gui perft bench pooltest uci epd match
 
-HEADERS  += \
-    BoardWindow.h \
-    insist.h \
-    Application.h \
-    BoardScene.h \
-    BoardView.h \
-    PieceList.h \
-    PieceGraphicsItem.h \
-    Engine.h
+gui.file = gui.pro
 
-RESOURCES += \
-    resources.qrc
+gui.depends = core
+perft.depends = core
+bench.depends = core
+pooltest.depends = core
+uci.depends = core
+epd.depends = core
+match.depends = core
 
-CONFIG += c++11
+# the Google Benchmark micro-benchmarks need libbenchmark, so they're only built
+# with qmake CONFIG+=gbench
+gbench {
+    SUBDIRS += microbench guibench
+    microbench.depends = core
+    guibench.depends = core
+}
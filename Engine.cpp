@@ -1,16 +1,181 @@
 #include "Engine.h"
+#include "Attacks.h"
+#include "MoveGenerator.h"
+#include "insist.h"
 
-Engine::Engine (bool humanIsWhite)
+/*
+ * Engine plays on the PieceList it's given, which is owned by whoever made the engine.
+ */
+
+Engine::Engine (PieceList*pieceList, bool humanIsWhite, EnginePool*pool) : main (&tt, 0), moveTime (DEFAULT_MOVE_TIME)
 {
+  insist (pieceList);
+  Attacks::init ();
+  this->pieceList = pieceList;
   this->humanIsWhite = humanIsWhite;
+  this->pool = pool ? pool : EnginePool::getShared ();
+  ponder = true;
+  main.setHelpers (&helpers);
+}
+
+Engine::~Engine ()
+{
+  setThreads (1);
+}
+
+/*
+ * can't be called during a think
+ */
+
+void Engine::setThreads (int threads)
+{
+  insist (threads > 0);
+
+  while ((int) helpers.size () + 1 > threads)
+  {
+    delete helpers.back ();
+    helpers.pop_back ();
+  }
+  while ((int) helpers.size () + 1 < threads)
+    helpers.push_back (new Search (&tt, (int) helpers.size () + 1));
+}
+
+/*
+ * true if it's the human's move
+ */
+
+bool Engine::isHumanTurn ()
+{
+  return (pieceList->getSideToMove () == PieceList::White) == humanIsWhite;
+}
+
+/*
+ * true if the side to move is in check
+ */
+
+bool Engine::inCheck ()
+{
+  return MoveGenerator::inCheck (*pieceList);
+}
+
+/*
+ * fill moves with the legal moves for the side to move
+ */
+
+void Engine::getLegalMoves (MoveList&moves)
+{
+  MoveGenerator::generate (*pieceList, moves);
 }
 
 /*
  * if it's legal, move the piece from "from" to "to and return true.
- * return false otherwise.
+ * return false otherwise, which includes it not being the human's turn.
+ * pawns reaching the last rank always become queens.
  */
 
 bool Engine::humanMove (int fromBoardIndex, int toBoardIndex)
 {
-  return fromBoardIndex % 2;
+  insist (fromBoardIndex >= 0 && fromBoardIndex < 64);
+  insist (toBoardIndex >= 0 && toBoardIndex < 64);
+
+  if (!isHumanTurn ())
+    return false;
+
+  MoveList moves;
+  getLegalMoves (moves);
+
+  for (Move move : moves)
+  {
+    if (move.getFrom () == fromBoardIndex && move.getTo () == toBoardIndex &&
+        (move.getType () != Move::Promotion || move.getPromotion () == PieceList::Queen))
+    {
+      pieceList->makeMove (move);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * think about position for the move time (or node limit) and return the best move found,
+ * or a null move if there are no legal moves. a book move is played without thinking at all.
+ * this doesn't touch the pieceList so it can run on another thread, as long as only one think
+ * is running at a time. hurry is for a think that was told to stop before it began, it only
+ * looks one ply deep.
+ */
+
+Move Engine::think (PieceList position, bool hurry, Search::InfoCallback callback)
+{
+  Move move = getBookMove (position);
+  if (!move.isNull ())
+    return move;
+  Search::Limits l = limits;
+  l.moveTime = moveTime;
+  if (hurry)
+  {
+    l.depth = 1;
+    l.infinite = false;
+  }
+  return pool->think (&main, helpers, position, l, callback);
+}
+
+/*
+ * a move from the book for position, or a null move if there's no book or it's out of moves
+ */
+
+Move Engine::getBookMove (PieceList&position)
+{
+  if (!book)
+    return Move ();
+  return book->probe (position);
+}
+
+/*
+ * stop a think in progress, which then returns the best move so far. safe from any thread.
+ */
+
+void Engine::stop ()
+{
+  pool->stop (&main);
+}
+
+/*
+ * forget any stop from before, ahead of the next think. think doesn't do this itself so a
+ * stop sent as it starts isn't lost, the caller does it before anything can send one.
+ */
+
+void Engine::clearStop ()
+{
+  main.clearStop ();
+}
+
+/*
+ * make move on the pieceList if it's legal there, and return whether it was
+ */
+
+bool Engine::playMove (Move move)
+{
+  MoveList moves;
+  getLegalMoves (moves);
+  if (!moves.contains (move))
+    return false;
+
+  pieceList->makeMove (move);
+  return true;
+}
+
+/*
+ * think about the pieceList and play the best move on it. returns the move, or a null move
+ * if the game is over. this blocks for the whole think.
+ */
+
+Move Engine::computerMove ()
+{
+  insist (!isHumanTurn ());
+
+  clearStop ();
+  Move move = think (*pieceList);
+  if (!move.isNull ())
+    playMove (move);
+  return move;
 }
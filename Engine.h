@@ -1,18 +1,131 @@
 #ifndef Engine_h
 #define Engine_h
 
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "PieceList.h"
+#include "MoveList.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "EnginePool.h"
+#include "Book.h"
+
+/*
+ * one game's engine: it checks and plays moves on the game's PieceList and thinks about it.
+ * the thinking is done on an EnginePool's threads, by default the one every engine shares, with
+ * a hash table and searches of the engine's own.
+ */
+
 class Engine
 {
   public:
-  Engine (bool humanIsWhite = true);
+  enum
+  {
+    DEFAULT_MOVE_TIME = 2000 //milliseconds
+  };
+
+  Engine (PieceList*pieceList, bool humanIsWhite = true, EnginePool*pool = 0);
+  ~Engine ();
   bool humanMove (int fromBoardIndex, int toBoardIndex);
+  Move computerMove ();
+  Move think (PieceList position, bool hurry = false, Search::InfoCallback callback = nullptr);
+  Move getBookMove (PieceList&position);
+  void stop ();
+  void clearStop ();
+  bool playMove (Move move);
+  void getLegalMoves (MoveList&moves);
+  bool isHumanTurn ();
+  bool inCheck ();
   bool getHumanIsWhite ()
   {
     return humanIsWhite;
   }
 
+  /*
+   * how long the engine thinks about each move, and optionally a node budget too. the move
+   * time can be changed from any thread, it counts from the next think.
+   */
+  void setMoveTime (int milliseconds)
+  {
+    moveTime = milliseconds;
+  }
+
+  int getMoveTime ()
+  {
+    return moveTime;
+  }
+
+  void setNodeLimit (long long nodes)
+  {
+    limits.nodes = nodes;
+  }
+
+  /*transposition table size in megabytes, this clears the table*/
+  void setHashSize (int megabytes)
+  {
+    tt.resize (megabytes);
+  }
+
+  int getHashSize ()
+  {
+    return tt.getSize ();
+  }
+
+  /*every thread's counts for the last think, see Search::getStats. not during a think*/
+  Search::Stats getStats ()
+  {
+    return main.getStats ();
+  }
+
+  /*the most threads a search uses, lazy smp helpers included, if the pool has them to spare*/
+  void setThreads (int threads);
+
+  int getThreads ()
+  {
+    return (int) helpers.size () + 1;
+  }
+
+  /*the opening book to play from, null for none. books are shared, see Book::open*/
+  void setBook (std::shared_ptr<Book> book)
+  {
+    this->book = book;
+  }
+
+  /*whether to think on the human's time, about the reply the engine expects*/
+  void setPonder (bool ponder)
+  {
+    this->ponder = ponder;
+  }
+
+  bool getPonder ()
+  {
+    return ponder;
+  }
+
+  /*
+   * mark the next think as a ponder search, which has no time limit and doesn't return until
+   * it's stopped or this is set back to false (a ponderhit). safe from any thread.
+   */
+  void setPondering (bool pondering)
+  {
+    if (pondering)
+      main.setPondering (true);
+    else
+      pool->ponderhit (&main);
+  }
+
   private:
+  PieceList*pieceList;
   bool humanIsWhite;
+  bool ponder;
+  std::shared_ptr<Book> book;
+  EnginePool*pool;
+  TranspositionTable tt;
+  Search main;
+  std::vector<Search*>helpers;
+  Search::Limits limits;
+  std::atomic<int> moveTime;
 };
 
 #endif // Engine_h
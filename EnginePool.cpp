@@ -0,0 +1,343 @@
+#include <algorithm>
+#include "EnginePool.h"
+#include "insist.h"
+
+EnginePool::EnginePool (int threads) : quitting (false)
+{
+  insist (threads > 0);
+  startWorkers (threads);
+}
+
+EnginePool::~EnginePool ()
+{
+  stopWorkers ();
+}
+
+/*
+ * the pool the app's engines share, one thread per core, made the first time it's asked for
+ */
+
+EnginePool*EnginePool::getShared ()
+{
+  static EnginePool pool (std::max (1, (int) std::thread::hardware_concurrency ()));
+  return &pool;
+}
+
+/*
+ * change the number of threads. can't be called while anything is searching.
+ */
+
+void EnginePool::setThreadCount (int threads)
+{
+  insist (threads > 0);
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    insist (jobs.empty ());
+  }
+
+  if (threads != getThreadCount ())
+  {
+    stopWorkers ();
+    startWorkers (threads);
+  }
+}
+
+void EnginePool::startWorkers (int threads)
+{
+  quitting = false;
+  for (int i = 0; i < threads; i++)
+    workers.push_back (std::thread (&EnginePool::work, this));
+}
+
+void EnginePool::stopWorkers ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    quitting = true;
+  }
+  wake.notify_all ();
+
+  for (std::thread&t : workers)
+    t.join ();
+  workers.clear ();
+}
+
+/*
+ * the real (not pondering) searches going on or waiting. the rest of these run with mutex held.
+ */
+
+int EnginePool::getActive ()
+{
+  int active = 0;
+  for (Job*job : jobs)
+    if (!job->finished && !job->main->isPondering ())
+      active++;
+  return active;
+}
+
+/*
+ * how many threads each real search gets, rounded up so none are left idle
+ */
+
+int EnginePool::getShare ()
+{
+  int active = getActive ();
+  return active ? ((int) workers.size () + active - 1) / active : (int) workers.size ();
+}
+
+/*
+ * how many threads job should have. a ponder search only gets more than one when there's no
+ * real search that could use them, as with uci's pool, which only ever has the one search.
+ */
+
+int EnginePool::getWanted (Job*job, int share)
+{
+  if (job->main->isPondering () && getActive () > 0)
+    return 1;
+  return std::min (share, (int) job->helpers->size () + 1);
+}
+
+/*
+ * the next thing for a free thread to do, if there's anything: start the oldest search that's
+ * waiting, real ones before ponder searches, otherwise lend a helper to the search that has the
+ * fewest threads, if it's under its share. a helper stopped to free its thread for another search
+ * can have one again, one that came to the end of its search (its depth, say) is done for the job.
+ */
+
+bool EnginePool::pick (Job*&job, int&index)
+{
+  for (int pass = 0; pass < 2; pass++)
+    for (Job*j : jobs)
+      if (!j->started && j->main->isPondering () == (pass == 1))
+      {
+        job = j;
+        index = 0;
+        return true;
+      }
+
+  int share = getShare (), fewest = 0;
+  job = 0;
+  for (Job*j : jobs)
+  {
+    if (j->finished)
+      continue;
+    int active = (int) std::count (j->state.begin (), j->state.end (), (int) Running);
+    if (active >= getWanted (j, share) || (job && active >= fewest))
+      continue;
+
+    for (size_t i = 1; i < j->state.size (); i++)
+      if (j->state [i] == Idle)
+      {
+        job = j;
+        index = (int) i;
+        fewest = active;
+        break;
+      }
+  }
+  return job != 0;
+}
+
+/*
+ * if searches are waiting for a thread and none are free, take threads back: helpers from the
+ * searches with the most over what they should have first (ponder searches' helpers too), then
+ * ponder searches
+ */
+
+void EnginePool::preempt ()
+{
+  int freeing = (int) workers.size (), waiting = 0;
+  for (Job*job : jobs)
+  {
+    for (int s : job->state)
+      freeing -= s == Running;
+    if (!job->started && !job->main->isPondering ())
+      waiting++;
+  }
+
+  int share = getShare ();
+  while (waiting > freeing)
+  {
+    Job*victim = 0;
+    int most = 0;
+    for (Job*job : jobs)
+    {
+      if (job->finished || !job->started)
+        continue;
+      int over = (int) std::count (job->state.begin (), job->state.end (), (int) Running) - getWanted (job, share);
+      if (over > most)
+      {
+        victim = job;
+        most = over;
+      }
+    }
+
+    if (victim)
+    {
+      for (size_t i = victim->state.size () - 1; i > 0; i--)
+        if (victim->state [i] == Running)
+        {
+          victim->state [i] = Stopping;
+          (*victim->helpers) [i - 1]->stop ();
+          break;
+        }
+    }
+    else
+    {
+      for (Job*job : jobs)
+        if (job->main->isPondering () && job->state [0] == Running)
+        {
+          victim = job;
+          break;
+        }
+      if (!victim)
+        return;
+      victim->state [0] = Stopping;
+      victim->ponderStopped = true;
+      victim->main->stop ();
+    }
+    freeing++;
+  }
+}
+
+/*
+ * a worker's loop: take the next thing to do, run that search and go back for more
+ */
+
+void EnginePool::work ()
+{
+  std::unique_lock<std::mutex> lock (mutex);
+  while (true)
+  {
+    Job*job;
+    int index;
+    wake.wait (lock, [this, &job, &index] () { return quitting || pick (job, index); });
+    if (quitting)
+      return;
+
+    Search*search = index == 0 ? job->main : (*job->helpers) [index - 1];
+    job->state [index] = Running;
+    job->running++;
+    if (index == 0)
+      job->started = true;
+    else
+      search->clearStop ();
+    Search::Limits limits = job->limits;
+
+    lock.unlock ();
+    Move move = search->think (job->position, limits, index == 0 ? job->callback : nullptr);
+    lock.lock ();
+
+    /*only a search taken off for another one has anything left to do*/
+    bool again = job->state [index] == Stopping && (index == 0 ? !job->stopped : !job->finished);
+    job->state [index] = again ? Idle : Done;
+    job->running--;
+
+    /*
+     * a ponder search stopped for a real one starts over, rather than coming back with that move.
+     * the stop cleared its pondering, it's only a real search now if there's been a ponderhit.
+     */
+    if (index == 0 && again)
+    {
+      job->started = false;
+      job->main->clearStop ();
+      job->main->setPondering (job->ponderStopped);
+    }
+
+    /*otherwise the main search decides when everyone is done*/
+    else if (index == 0)
+    {
+      job->finished = true;
+      job->move = move;
+      for (size_t i = 1; i < job->state.size (); i++)
+        if (job->state [i] == Running)
+        {
+          job->state [i] = Stopping;
+          (*job->helpers) [i - 1]->stop ();
+        }
+    }
+
+    if (job->finished && job->running == 0)
+    {
+      job->done = true;
+      jobs.erase (std::find (jobs.begin (), jobs.end (), job));
+      done.notify_all ();
+    }
+
+    /*there's a thread free, and the shares may have changed*/
+    wake.notify_all ();
+  }
+}
+
+/*
+ * search position with main and as many of helpers as get a thread, and return main's move.
+ * this blocks until the search is over but doesn't take a thread itself, the searching is all
+ * done by the pool. main's stop flag is the caller's to clear, see Search::clearStop.
+ */
+
+Move EnginePool::think (Search*main, std::vector<Search*>&helpers, PieceList&position, Search::Limits limits,
+                        Search::InfoCallback callback)
+{
+  Job job;
+  job.main = main;
+  job.helpers = &helpers;
+  job.position = position;
+  job.limits = limits;
+  job.callback = callback;
+  job.state.assign (helpers.size () + 1, Idle);
+  job.running = 0;
+  job.started = job.stopped = job.ponderStopped = job.finished = job.done = false;
+
+  /*helpers count over every run they get in this job, and nothing from the last one*/
+  for (Search*h : helpers)
+    h->clearStats ();
+
+  std::unique_lock<std::mutex> lock (mutex);
+  jobs.push_back (&job);
+  preempt ();
+  wake.notify_all ();
+
+  done.wait (lock, [&job] () { return job.done; });
+  return job.move;
+}
+
+/*
+ * stop main's search, safe from any thread. one that hasn't got a thread yet (or is waiting to
+ * start over) is cut down to depth 1 instead, so it still comes back with a proper move, straight
+ * away. one that hasn't been asked for yet finds the flag set and comes back with the first legal
+ * move.
+ */
+
+void EnginePool::stop (Search*main)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  for (Job*job : jobs)
+    if (job->main == main && !job->finished)
+    {
+      if (!job->started)
+      {
+        job->limits.depth = 1;
+        job->limits.infinite = false;
+        main->setPondering (false);
+        return;
+      }
+      job->stopped = true;
+    }
+  main->stop ();
+}
+
+/*
+ * main's ponder search is a real one now, safe from any thread. it goes through the pool rather
+ * than straight to main so a ponder search that's waiting to start over hears about it too. then
+ * the shares are looked at again.
+ */
+
+void EnginePool::ponderhit (Search*main)
+{
+  std::lock_guard<std::mutex> lock (mutex);
+  main->setPondering (false);
+  for (Job*job : jobs)
+    if (job->main == main)
+      job->ponderStopped = false;
+  preempt ();
+  wake.notify_all ();
+}
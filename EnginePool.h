@@ -0,0 +1,96 @@
+#ifndef EnginePool_h
+#define EnginePool_h
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include "Search.h"
+
+/*
+ * worker threads shared by every Engine in the process, so a dozen games on one machine run
+ * on as many threads as there are cores rather than a dozen times that.
+ *
+ * each engine brings its own Searches (a main one and lazy smp helpers) and its own hash
+ * table, the pool only lends them threads. a search asked for while every thread is busy
+ * waits its turn, first come first served. the threads are shared out fairly between the
+ * searches going on: each gets at most its share of them (all of them when it's alone), a
+ * new search takes threads back from ones over their share by stopping helpers, which lazy
+ * smp doesn't mind, and when a search finishes the others pick up the threads it frees.
+ *
+ * ponder searches come last. they only start when no real search is waiting, get one thread
+ * while there's a real search going on (all they can use when there isn't), and are stopped
+ * outright when a real search needs their last thread. the move they had then isn't worth
+ * anything, so they go back to waiting and start over when there's a thread again, as real
+ * searches if there's been a ponderhit in the meantime.
+ *
+ * with threads of its own a pool is also how a single search runs lazy smp, uci and bench
+ * each have one like that.
+ *
+ * the tables everything reads but nothing writes (attacks, books, tablebases) are already
+ * shared between engines, since they're static or shared pointers.
+ */
+
+class EnginePool
+{
+  public:
+  EnginePool (int threads);
+  ~EnginePool ();
+  static EnginePool*getShared ();
+  void setThreadCount (int threads);
+  Move think (Search*main, std::vector<Search*>&helpers, PieceList&position, Search::Limits limits,
+              Search::InfoCallback callback = nullptr);
+  void stop (Search*main);
+  void ponderhit (Search*main);
+
+  int getThreadCount ()
+  {
+    return (int) workers.size ();
+  }
+
+  private:
+  /*one think: its searches, and which of them have a thread*/
+  struct Job
+  {
+    Search*main;
+    std::vector<Search*>*helpers;
+    PieceList position;
+    Search::Limits limits;
+    Search::InfoCallback callback;
+    std::vector<int>state; //per search, main first: Idle, Running, Stopping or Done
+    int running; //threads on it, Stopping ones included
+    bool started; //the main search has a thread, or has had one and finished
+    bool stopped; //stop () has been called since it started
+    bool ponderStopped; //its ponder search was stopped for a real one, with no ponderhit since
+    bool finished; //the main search is done, the helpers are on their way out
+    bool done; //every thread is off it, think can return
+    Move move;
+  };
+
+  enum
+  {
+    Idle,
+    Running,
+    Stopping, //told to stop to free its thread for another search
+    Done //came to the end of its search, it isn't lent a thread again
+  };
+
+  std::mutex mutex;
+  std::condition_variable wake; //workers wait on this for something to do, or to quit
+  std::condition_variable done; //think waits on this for its job to be done
+  std::deque<Job*>jobs; //waiting or running, oldest first
+  std::vector<std::thread>workers;
+  bool quitting;
+
+  void work ();
+  bool pick (Job*&job, int&index);
+  void preempt ();
+  int getActive ();
+  int getShare ();
+  int getWanted (Job*job, int share);
+  void startWorkers (int threads);
+  void stopWorkers ();
+};
+
+#endif // EnginePool_h
@@ -0,0 +1,56 @@
+#include "EngineWorker.h"
+#include "insist.h"
+
+EngineWorker::EngineWorker (Engine*engine) : QObject (0), stoppedId (0)
+{
+  insist (engine);
+  this->engine = engine;
+  qRegisterMetaType<PieceList> ("PieceList");
+  qRegisterMetaType<Search::Stats> ("Search::Stats");
+}
+
+/*
+ * stop request id, and any before it, so they come back with the best move so far. safe from
+ * any thread. a request that hasn't started yet only looks one ply deep when it does.
+ */
+
+void EngineWorker::stop (int id)
+{
+  stoppedId = id;
+  engine->stop ();
+}
+
+/*
+ * slot, run on the worker's thread. searches position and sends back the info lines as the
+ * search deepens and the move at the end, as Move::getData (), null if there's no legal move.
+ * with the move comes the reply the engine expects, from the principal variation, or null.
+ * before the move go the search's counts, unless it was a book move and there wasn't a search.
+ */
+
+void EngineWorker::think (int id, PieceList position)
+{
+  std::vector<Move>lastPv;
+  bool searched = false;
+
+  /*
+   * cleared before the id is read: a stop that comes after the read sets the flag again, so
+   * either the search knows it's been stopped or it's told while it runs
+   */
+  engine->clearStop ();
+  bool hurry = id <= stoppedId;
+  Move move = engine->think (position, hurry, [this, id, &lastPv, &searched] (Search::Info&i)
+  {
+    lastPv = i.pv;
+    searched = true;
+    QString pv;
+    for (Move m : i.pv)
+      pv += QString::fromStdString (m.toString ()) + " ";
+    emit info (id, i.depth, i.score, i.nodes, i.time, pv.trimmed ());
+  });
+
+  if (searched)
+    emit stats (id, engine->getStats ());
+
+  Move ponderMove = lastPv.size () > 1 && lastPv [0] == move ? lastPv [1] : Move ();
+  emit bestMove (id, move.getData (), ponderMove.getData ());
+}
@@ -0,0 +1,44 @@
+#ifndef EngineWorker_h
+#define EngineWorker_h
+
+#include <atomic>
+#include <QObject>
+#include <QString>
+#include "Engine.h"
+
+Q_DECLARE_METATYPE (PieceList)
+Q_DECLARE_METATYPE (Search::Stats)
+
+/*
+ * EngineWorker runs an Engine's thinking on a thread of its own so the GUI thread never
+ * waits on a search. it lives on that thread (the owner does moveToThread), search requests
+ * reach it through a queued call to think () and results go back as signals, which qt
+ * queues over to the receiver's thread.
+ *
+ * every request carries an id that comes back with its results, so a receiver can drop
+ * results for requests it has since cancelled. stops go by id too, and straight to the worker
+ * rather than through the queue, so a stop for a request still waiting in the queue isn't lost.
+ */
+
+class EngineWorker : public QObject
+{
+  Q_OBJECT
+
+  public:
+  explicit EngineWorker (Engine*engine);
+  void stop (int id);
+
+  public slots:
+  void think (int id, PieceList position);
+
+  signals:
+  void bestMove (int id, int move, int ponderMove);
+  void info (int id, int depth, int score, qlonglong nodes, int time, QString pv);
+  void stats (int id, Search::Stats stats);
+
+  private:
+  Engine*engine;
+  std::atomic<int> stoppedId; //the latest request told to stop
+};
+
+#endif // EngineWorker_h
@@ -0,0 +1,355 @@
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include "Evaluator.h"
+#include "Attacks.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS
+#include <immintrin.h>
+#endif
+
+static const Bitboard FILE_A = 0x0101010101010101ULL;
+static const Bitboard FILE_H = FILE_A << 7;
+
+static Score S (int mg, int eg)
+{
+  return Psqt::makeScore (mg, eg);
+}
+
+/*pawn structure*/
+static const Score DOUBLED = S (-10, -20);
+static const Score ISOLATED = S (-10, -15);
+static const Score PASSED [8] = {S (0, 0), S (5, 10), S (10, 15), S (15, 25), S (25, 45), S (40, 75), S (60, 120), S (0, 0)};
+
+/*per square a piece attacks more than an ordinary number of them, for knight, bishop, rook, queen*/
+static const Score MOBILITY [4] = {S (4, 4), S (5, 5), S (2, 4), S (1, 2)};
+static const int MOBILITY_BASE [4] = {4, 6, 6, 12};
+
+/*king safety: how much each attacked square next to the king counts, by attacker type*/
+static const int KING_ATTACK_WEIGHT [4] = {2, 2, 3, 5};
+static const int SHIELD = 12;
+static const int MAX_KING_DANGER = 400;
+
+static const Score BISHOP_PAIR = S (30, 50);
+static const Score ROOK_OPEN_FILE = S (25, 10);
+static const Score ROOK_HALF_OPEN_FILE = S (10, 5);
+
+/*masks, filled in by init*/
+static Bitboard files [8];
+static Bitboard adjacentFiles [8];
+static Bitboard passedMasks [2][64]; //squares in front on the same and adjacent files
+static Bitboard frontSpans [2][64]; //squares in front on the same file
+static Bitboard shieldMasks [2][64]; //the two ranks in front of a king, its file and the ones next to it
+
+/*
+ * the batch popcount: counts [i] = popcount (boards [i] & mask) for i < n
+ */
+
+typedef void (*CountBits) (const Bitboard*boards, int n, Bitboard mask, int*counts);
+
+static void countBitsGeneric (const Bitboard*boards, int n, Bitboard mask, int*counts)
+{
+  for (int i = 0; i < n; i++)
+    counts [i] = Bitboards::popCount (boards [i] & mask);
+}
+
+#if defined(X86_KERNELS)
+__attribute__ ((target ("popcnt")))
+static void countBitsPopcnt (const Bitboard*boards, int n, Bitboard mask, int*counts)
+{
+  for (int i = 0; i < n; i++)
+    counts [i] = __builtin_popcountll (boards [i] & mask);
+}
+
+/*
+ * four boards at a time: each byte's bit count comes from a 16 entry table, one lookup per
+ * nibble with pshufb, then the bytes of each 64 bit lane are summed with psadbw
+ */
+
+__attribute__ ((target ("avx2,popcnt")))
+static void countBitsAvx2 (const Bitboard*boards, int n, Bitboard mask, int*counts)
+{
+  const __m256i table = _mm256_setr_epi8 (0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibbles = _mm256_set1_epi8 (0x0f);
+  const __m256i masks = _mm256_set1_epi64x ((long long) mask);
+
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256i v = _mm256_and_si256 (_mm256_loadu_si256 ((const __m256i*) (boards + i)), masks);
+    __m256i low = _mm256_shuffle_epi8 (table, _mm256_and_si256 (v, nibbles));
+    __m256i high = _mm256_shuffle_epi8 (table, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), nibbles));
+    __m256i sums = _mm256_sad_epu8 (_mm256_add_epi8 (low, high), _mm256_setzero_si256 ());
+
+    /*each sum is at most 64, so the low 32 bits of each lane are it*/
+    __m128i packed = _mm256_castsi256_si128 (_mm256_permutevar8x32_epi32 (sums, _mm256_setr_epi32 (0, 2, 4, 6, 0, 2, 4, 6)));
+    _mm_storeu_si128 ((__m128i*) (counts + i), packed);
+  }
+  for (; i < n; i++)
+    counts [i] = __builtin_popcountll (boards [i] & mask);
+}
+#endif
+
+static CountBits kernels [3] =
+{
+  countBitsGeneric,
+#if defined(X86_KERNELS)
+  countBitsPopcnt,
+  countBitsAvx2
+#else
+  countBitsGeneric,
+  countBitsGeneric
+#endif
+};
+
+/*setKernel can switch these while other threads evaluate*/
+static std::atomic<Evaluator::Kernel> kernel (Evaluator::Generic);
+static std::atomic<CountBits> countBits (countBitsGeneric);
+
+/*
+ * the masks, and the best kernel this CPU can run
+ */
+
+void Evaluator::init ()
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    Attacks::init ();
+
+    for (int f = 0; f < 8; f++)
+    {
+      files [f] = FILE_A << f;
+      adjacentFiles [f] = (f > 0 ? FILE_A << (f - 1) : 0) | (f < 7 ? FILE_A << (f + 1) : 0);
+    }
+
+    for (int square = 0; square < 64; square++)
+    {
+      int file = square % 8, rank = square / 8;
+      Bitboard above = rank < 7 ? ~(Bitboard) 0 << (8 * (rank + 1)) : 0;
+      Bitboard below = rank > 0 ? ~(Bitboard) 0 >> (8 * (8 - rank)) : 0;
+
+      frontSpans [PieceList::White][square] = above & files [file];
+      frontSpans [PieceList::Black][square] = below & files [file];
+      passedMasks [PieceList::White][square] = above & (files [file] | adjacentFiles [file]);
+      passedMasks [PieceList::Black][square] = below & (files [file] | adjacentFiles [file]);
+
+      Bitboard near = files [file] | adjacentFiles [file];
+      Bitboard twoAbove = rank < 7 ? (Bitboard) 0xffff << (8 * (rank + 1)) : 0;
+      Bitboard twoBelow = rank > 1 ? (Bitboard) 0xffff << (8 * (rank - 2)) : rank == 1 ? (Bitboard) 0xff : 0;
+      shieldMasks [PieceList::White][square] = near & twoAbove;
+      shieldMasks [PieceList::Black][square] = near & twoBelow;
+    }
+
+    for (int k = Avx2; k > Generic; k--)
+      if (isSupported ((Kernel) k))
+      {
+        kernel.store ((Kernel) k, std::memory_order_relaxed);
+        countBits.store (kernels [k], std::memory_order_relaxed);
+        break;
+      }
+  });
+}
+
+bool Evaluator::isSupported (Kernel k)
+{
+#if defined(X86_KERNELS)
+  __builtin_cpu_init ();
+  if (k == Avx2)
+    return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("popcnt");
+  if (k == Popcnt)
+    return __builtin_cpu_supports ("popcnt");
+#endif
+  return k == Generic;
+}
+
+/*
+ * use kernel k from now on, for benchmarking them against each other. returns false,
+ * changing nothing, if this CPU can't run it. evaluations already under way finish on the
+ * kernel they started with.
+ */
+
+bool Evaluator::setKernel (Kernel k)
+{
+  init ();
+  if (!isSupported (k))
+    return false;
+  kernel.store (k, std::memory_order_relaxed);
+  countBits.store (kernels [k], std::memory_order_relaxed);
+  return true;
+}
+
+Evaluator::Kernel Evaluator::getKernel ()
+{
+  init ();
+  return kernel.load (std::memory_order_relaxed);
+}
+
+const char*Evaluator::getKernelName (Kernel k)
+{
+  static const char*names [3] = {"generic", "popcnt", "avx2"};
+  return names [k];
+}
+
+Evaluator::Evaluator () : pawnTable ((size_t) 1 << PAWN_TABLE_BITS)
+{
+  init ();
+  clear ();
+}
+
+/*
+ * empty the pawn table. an all zero entry is right for a position with no pawns, so there's
+ * no need to mark entries as unused.
+ */
+
+void Evaluator::clear ()
+{
+  std::fill (pawnTable.begin (), pawnTable.end (), PawnEntry ());
+}
+
+static Bitboard pawnAttacks (Bitboard pawns, PieceList::Color color)
+{
+  if (color == PieceList::White)
+    return ((pawns << 7) & ~FILE_H) | ((pawns << 9) & ~FILE_A);
+  return ((pawns >> 9) & ~FILE_H) | ((pawns >> 7) & ~FILE_A);
+}
+
+/*
+ * the pawn structure score for color, which is only ever worked out on a miss in the pawn table
+ */
+
+Score Evaluator::evaluatePawns (PieceList&position, PieceList::Color color)
+{
+  Bitboard ours = position.getPieces (PieceList::Pawn, color);
+  Bitboard theirs = position.getPieces (PieceList::Pawn, (PieceList::Color) !color);
+  Score score = 0;
+
+  for (Bitboard b = ours; b; )
+  {
+    int square = Bitboards::popLsb (b);
+    int file = square % 8;
+    int relativeRank = color == PieceList::White ? square / 8 : 7 - square / 8;
+
+    if (ours & frontSpans [color][square])
+      score += DOUBLED;
+    if (!(ours & adjacentFiles [file]))
+      score += ISOLATED;
+    if (!(theirs & passedMasks [color][square]) && !(ours & frontSpans [color][square]))
+      score += PASSED [relativeRank];
+  }
+  return score;
+}
+
+/*
+ * the entry for position's pawns, filled in if it wasn't there
+ */
+
+Evaluator::PawnEntry*Evaluator::probePawns (PieceList&position)
+{
+  Bitboard white = position.getPieces (PieceList::wPawn);
+  Bitboard black = position.getPieces (PieceList::bPawn);
+  Bitboard hash = white * 0x9E3779B97F4A7C15ULL ^ black * 0xC2B2AE3D27D4EB4FULL;
+  PawnEntry*entry = &pawnTable [(size_t) (hash >> (64 - PAWN_TABLE_BITS))];
+
+  if (entry->pawns [PieceList::White] != white || entry->pawns [PieceList::Black] != black)
+  {
+    entry->pawns [PieceList::White] = white;
+    entry->pawns [PieceList::Black] = black;
+    entry->attacks [PieceList::White] = pawnAttacks (white, PieceList::White);
+    entry->attacks [PieceList::Black] = pawnAttacks (black, PieceList::Black);
+    entry->score = evaluatePawns (position, PieceList::White) - evaluatePawns (position, PieceList::Black);
+  }
+  return entry;
+}
+
+/*
+ * mobility, attacks on the enemy king, the shield in front of color's own king, the bishop
+ * pair and rooks on open files, for color
+ */
+
+Score Evaluator::evaluatePieces (PieceList&position, PieceList::Color color, Bitboard enemyPawnAttacks)
+{
+  PieceList::Color them = (PieceList::Color) !color;
+  Bitboard occupied = position.getOccupied ();
+  Bitboard ourPawns = position.getPieces (PieceList::Pawn, color);
+  Bitboard theirPawns = position.getPieces (PieceList::Pawn, them);
+  Score score = 0;
+
+  /*everything the pieces attack, in one array for the kernel*/
+  Bitboard attacks [32];
+  int types [32];
+  int n = 0;
+  for (int type = PieceList::Knight; type <= PieceList::Queen; type++)
+  {
+    for (Bitboard b = position.getPieces ((PieceList::PieceType) type, color); b; n++)
+    {
+      int square = Bitboards::popLsb (b);
+      types [n] = type - PieceList::Knight;
+      attacks [n] = type == PieceList::Knight ? Attacks::knight (square) :
+                    type == PieceList::Bishop ? Attacks::bishop (square, occupied) :
+                    type == PieceList::Rook ? Attacks::rook (square, occupied) :
+                    Attacks::queen (square, occupied);
+
+      if (type == PieceList::Rook)
+      {
+        if (!((ourPawns | theirPawns) & files [square % 8]))
+          score += ROOK_OPEN_FILE;
+        else if (!(ourPawns & files [square % 8]))
+          score += ROOK_HALF_OPEN_FILE;
+      }
+    }
+  }
+
+  int enemyKing = position.getKingSquare (them);
+  Bitboard mobilityArea = ~(ourPawns | position.getPieces (PieceList::King, color) | enemyPawnAttacks);
+  Bitboard kingZone = Attacks::king (enemyKing) | Bitboards::bit (enemyKing);
+
+  int mobility [32], kingAttacks [32];
+  CountBits count = countBits.load (std::memory_order_relaxed);
+  count (attacks, n, mobilityArea, mobility);
+  count (attacks, n, kingZone, kingAttacks);
+
+  int attackers = 0, danger = 0;
+  for (int i = 0; i < n; i++)
+  {
+    score += MOBILITY [types [i]] * (mobility [i] - MOBILITY_BASE [types [i]]);
+    if (kingAttacks [i])
+    {
+      attackers++;
+      danger += KING_ATTACK_WEIGHT [types [i]] * kingAttacks [i];
+    }
+  }
+
+  /*one piece near the king isn't an attack, and it doesn't matter much without the queens*/
+  if (attackers >= 2)
+    score += S (std::min (danger * danger / 4, MAX_KING_DANGER), danger);
+
+  int king = position.getKingSquare (color);
+  int kingRank = color == PieceList::White ? king / 8 : 7 - king / 8;
+  if (kingRank <= 1)
+    score += S (SHIELD * Bitboards::popCount (ourPawns & shieldMasks [color][king]), 0);
+
+  if (Bitboards::moreThanOne (position.getPieces (PieceList::Bishop, color)))
+    score += BISHOP_PAIR;
+  return score;
+}
+
+int Evaluator::evaluate (PieceList&position)
+{
+  PawnEntry*pawns = probePawns (position);
+  Score score = position.getPsq () + pawns->score
+              + evaluatePieces (position, PieceList::White, pawns->attacks [PieceList::Black])
+              - evaluatePieces (position, PieceList::Black, pawns->attacks [PieceList::White]);
+
+  int phase = 0;
+  for (PieceList::Color color : {PieceList::White, PieceList::Black})
+    phase += Bitboards::popCount (position.getPieces (PieceList::Knight, color) | position.getPieces (PieceList::Bishop, color))
+           + 2 * Bitboards::popCount (position.getPieces (PieceList::Rook, color))
+           + 4 * Bitboards::popCount (position.getPieces (PieceList::Queen, color));
+  phase = std::min (phase, (int) MAX_PHASE);
+
+  int value = (Psqt::getMg (score) * phase + Psqt::getEg (score) * (MAX_PHASE - phase)) / MAX_PHASE;
+  return position.getSideToMove () == PieceList::White ? value : -value;
+}
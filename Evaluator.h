@@ -0,0 +1,82 @@
+#ifndef Evaluator_h
+#define Evaluator_h
+
+#include <vector>
+#include "PieceList.h"
+
+/*
+ * static evaluation, in centipawns from the point of view of the side to move.
+ *
+ * every term has a middlegame and an endgame value (a Score, see Psqt.h), and the two are
+ * blended by the phase, how much non-pawn material is left. the terms are
+ *
+ * - material and piece-square tables, which PieceList keeps summed up as moves are made, so
+ *   they cost nothing here
+ * - pawn structure: doubled, isolated and passed pawns. it only depends on where the pawns
+ *   are, which rarely changes between one node and the next, so it's kept in a small hash
+ *   table keyed on the pawns
+ * - mobility, the squares each piece attacks that aren't covered by enemy pawns
+ * - king safety: the pawn shield, and how many pieces attack the squares around the king
+ *   and how hard
+ * - the bishop pair and rooks on open files
+ *
+ * mobility and king attacks are popcounts of every piece's attack set against a mask, done
+ * as one batch by a kernel picked at run time for the CPU: AVX2, the popcnt instruction, or
+ * plain C++ for anything else. the library is built for a baseline x86 without either, so
+ * this is the only way the evaluation gets them. the kernel only does those popcounts: the
+ * attack sets, scoring the counts, the pawn terms and the king shield are all plain code.
+ *
+ * an Evaluator holds the pawn hash table, so each search thread wants its own.
+ */
+
+class Evaluator
+{
+  public:
+  /*the batch popcount implementations, in order of preference*/
+  enum Kernel
+  {
+    Generic,
+    Popcnt,
+    Avx2
+  };
+
+  Evaluator ();
+  int evaluate (PieceList&position);
+  void clear ();
+
+  static Kernel getKernel ();
+  static bool setKernel (Kernel kernel);
+  static bool isSupported (Kernel kernel);
+  static const char*getKernelName (Kernel kernel);
+
+  /*material value of a piece type, used by move ordering too*/
+  static int pieceValue (int type)
+  {
+    static int values [6] = {100, 320, 330, 500, 900, 0};
+    return values [type];
+  }
+
+  private:
+  enum
+  {
+    PAWN_TABLE_BITS = 13, //8192 entries, 320k
+    MAX_PHASE = 24
+  };
+
+  /*the pawns are the key, all of them, so there are no collisions*/
+  struct PawnEntry
+  {
+    Bitboard pawns [2];
+    Bitboard attacks [2];
+    Score score;
+  };
+
+  std::vector<PawnEntry>pawnTable;
+
+  PawnEntry*probePawns (PieceList&position);
+  static Score evaluatePawns (PieceList&position, PieceList::Color color);
+  static Score evaluatePieces (PieceList&position, PieceList::Color color, Bitboard enemyPawnAttacks);
+  static void init ();
+};
+
+#endif // Evaluator_h
@@ -0,0 +1,100 @@
+#include "MappedFile.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile () : data (0), size (0)
+{
+#if defined(_WIN32)
+  file = mapping = 0;
+#endif
+}
+
+MappedFile::~MappedFile ()
+{
+  close ();
+}
+
+/*
+ * map the file at path, closing whatever was open before. returns false if it can't be
+ * opened or is empty. access is a hint about how the file is going to be read.
+ */
+
+bool MappedFile::open (std::string path, Access access)
+{
+  close ();
+
+#if defined(_WIN32)
+  HANDLE f = CreateFileA (path.c_str (), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                          access == Random ? FILE_FLAG_RANDOM_ACCESS : access == Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : 0, 0);
+  if (f == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx (f, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle (f);
+    return false;
+  }
+
+  HANDLE m = CreateFileMappingA (f, 0, PAGE_READONLY, 0, 0, 0);
+  void*view = m ? MapViewOfFile (m, FILE_MAP_READ, 0, 0, 0) : 0;
+  if (!view)
+  {
+    if (m)
+      CloseHandle (m);
+    CloseHandle (f);
+    return false;
+  }
+
+  file = f;
+  mapping = m;
+  data = (unsigned char*) view;
+  size = (size_t) fileSize.QuadPart;
+#else
+  int fd = ::open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+  {
+    ::close (fd);
+    return false;
+  }
+
+  void*view = mmap (0, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close (fd); //the mapping keeps the file open
+  if (view == MAP_FAILED)
+    return false;
+
+  if (access != Normal)
+    madvise (view, (size_t) st.st_size, access == Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+  data = (unsigned char*) view;
+  size = (size_t) st.st_size;
+#endif
+  return true;
+}
+
+void MappedFile::close ()
+{
+  if (!data)
+    return;
+
+#if defined(_WIN32)
+  UnmapViewOfFile (data);
+  CloseHandle ((HANDLE) mapping);
+  CloseHandle ((HANDLE) file);
+  file = mapping = 0;
+#else
+  munmap (data, size);
+#endif
+  data = 0;
+  size = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <string>
+#include <cstddef>
+
+/*
+ * a whole file mapped read-only into memory. nothing is read until a page is touched, so
+ * opening even a huge file costs about the same as opening a small one, and the pages are
+ * shared with every other mapping of the file and stay in the OS's cache, not our heap.
+ */
+
+class MappedFile
+{
+  public:
+  enum Access
+  {
+    Normal,
+    Sequential, //read front to back, read ahead aggressively
+    Random //lookups all over, don't read ahead
+  };
+
+  MappedFile ();
+  ~MappedFile ();
+  bool open (std::string path, Access access = Normal);
+  void close ();
+
+  bool isOpen ()
+  {
+    return data != 0;
+  }
+
+  /*the file's bytes, which must not be written to*/
+  unsigned char*getData ()
+  {
+    return data;
+  }
+
+  size_t getSize ()
+  {
+    return size;
+  }
+
+  private:
+  unsigned char*data;
+  size_t size;
+#if defined(_WIN32)
+  void*file;
+  void*mapping;
+#endif
+
+  MappedFile (const MappedFile&) = delete;
+  MappedFile&operator= (const MappedFile&) = delete;
+};
+
+#endif // MappedFile_h
@@ -0,0 +1,106 @@
+#ifndef Move_h
+#define Move_h
+
+#include <string>
+
+/*
+ * a chess move packed into an int:
+ *
+ * bits 0-5    from square (LERF)
+ * bits 6-11   to square
+ * bits 12-13  type (normal, promotion, en passant, castling)
+ * bits 14-15  promotion piece, knight..queen stored as 0..3
+ *
+ * castling is encoded as the king's move, e1g1 and so on. the zero move (a1a1) is
+ * never legal so it doubles as "no move".
+ */
+
+class Move
+{
+  public:
+  enum Type
+  {
+    Normal,
+    Promotion,
+    EnPassant,
+    Castling
+  };
+
+  Move () : data (0)
+  {
+  }
+
+  /*promotion is a PieceList::PieceType, Knight through Queen*/
+  Move (int from, int to, Type type = Normal, int promotion = 1) :
+    data (from | (to << 6) | (type << 12) | ((promotion - 1) << 14))
+  {
+  }
+
+  int getFrom ()
+  {
+    return data & 63;
+  }
+
+  int getTo ()
+  {
+    return (data >> 6) & 63;
+  }
+
+  Type getType ()
+  {
+    return (Type) ((data >> 12) & 3);
+  }
+
+  int getPromotion ()
+  {
+    return ((data >> 14) & 3) + 1;
+  }
+
+  bool isNull ()
+  {
+    return data == 0;
+  }
+
+  int getData ()
+  {
+    return data;
+  }
+
+  /*coordinate notation as used by UCI, e2e4, e7e8q, castling as the king's move*/
+  std::string toString ()
+  {
+    if (isNull ())
+      return "0000";
+    std::string s;
+    s += (char) ('a' + getFrom () % 8);
+    s += (char) ('1' + getFrom () / 8);
+    s += (char) ('a' + getTo () % 8);
+    s += (char) ('1' + getTo () / 8);
+    if (getType () == Promotion)
+      s += "nbrq" [getPromotion () - 1];
+    return s;
+  }
+
+  /*inverse of getData, for moves that have been stored packed somewhere*/
+  static Move fromData (int data)
+  {
+    Move m;
+    m.data = data;
+    return m;
+  }
+
+  bool operator== (Move m)
+  {
+    return data == m.data;
+  }
+
+  bool operator!= (Move m)
+  {
+    return data != m.data;
+  }
+
+  private:
+  int data;
+};
+
+#endif // Move_h
@@ -0,0 +1,228 @@
+#include "MoveGenerator.h"
+#include "Attacks.h"
+
+/*
+ * every piece of either color attacking square, given occupied as the board's occupancy.
+ */
+
+Bitboard MoveGenerator::attackersTo (PieceList&p, int square, Bitboard occupied)
+{
+  Bitboard rooks = p.getPieces (PieceList::wRook) | p.getPieces (PieceList::bRook) |
+                   p.getPieces (PieceList::wQueen) | p.getPieces (PieceList::bQueen);
+  Bitboard bishops = p.getPieces (PieceList::wBishop) | p.getPieces (PieceList::bBishop) |
+                     p.getPieces (PieceList::wQueen) | p.getPieces (PieceList::bQueen);
+
+  return (Attacks::pawn (PieceList::White, square) & p.getPieces (PieceList::bPawn)) |
+         (Attacks::pawn (PieceList::Black, square) & p.getPieces (PieceList::wPawn)) |
+         (Attacks::knight (square) & (p.getPieces (PieceList::wKnight) | p.getPieces (PieceList::bKnight))) |
+         (Attacks::king (square) & (p.getPieces (PieceList::wKing) | p.getPieces (PieceList::bKing))) |
+         (Attacks::rook (square, occupied) & rooks) |
+         (Attacks::bishop (square, occupied) & bishops);
+}
+
+/*
+ * true if any piece of color by attacks square
+ */
+
+bool MoveGenerator::isAttacked (PieceList&p, int square, PieceList::Color by, Bitboard occupied)
+{
+  PieceList::Color us = (PieceList::Color) !by;
+
+  return (Attacks::pawn (us, square) & p.getPieces (PieceList::Pawn, by)) ||
+         (Attacks::knight (square) & p.getPieces (PieceList::Knight, by)) ||
+         (Attacks::king (square) & p.getPieces (PieceList::King, by)) ||
+         (Attacks::rook (square, occupied) & (p.getPieces (PieceList::Rook, by) | p.getPieces (PieceList::Queen, by))) ||
+         (Attacks::bishop (square, occupied) & (p.getPieces (PieceList::Bishop, by) | p.getPieces (PieceList::Queen, by)));
+}
+
+bool MoveGenerator::inCheck (PieceList&p)
+{
+  PieceList::Color us = p.getSideToMove ();
+  return isAttacked (p, p.getKingSquare (us), (PieceList::Color) !us, p.getOccupied ());
+}
+
+void MoveGenerator::addPromotions (MoveList&moves, int from, int to, GenType type, bool capture)
+{
+  /*a queen promotion counts as a capture, the underpromotions go with the captures only if they capture*/
+  if (type != Quiets)
+    moves.add (Move (from, to, Move::Promotion, PieceList::Queen));
+  if (type == All || (type == Captures) == capture)
+  {
+    moves.add (Move (from, to, Move::Promotion, PieceList::Rook));
+    moves.add (Move (from, to, Move::Promotion, PieceList::Bishop));
+    moves.add (Move (from, to, Move::Promotion, PieceList::Knight));
+  }
+}
+
+/*
+ * pawn pushes, captures, promotions and en passant. targets is the set of squares a move
+ * may land on (everything, or the check blocking squares when in check), pinned pawns
+ * only move along the line through the king.
+ */
+
+void MoveGenerator::generatePawnMoves (PieceList&p, MoveList&moves, GenType type, Bitboard targets, Bitboard pinned, int king)
+{
+  PieceList::Color us = p.getSideToMove ();
+  PieceList::Color them = (PieceList::Color) !us;
+  Bitboard occupied = p.getOccupied ();
+  Bitboard enemies = p.getOccupancy (them);
+  Bitboard pawns = p.getPieces (PieceList::Pawn, us);
+  int up = us == PieceList::White ? 8 : -8;
+  int startRank = us == PieceList::White ? 1 : 6;
+  int lastRank = us == PieceList::White ? 7 : 0;
+
+  while (pawns)
+  {
+    int from = Bitboards::popLsb (pawns);
+    Bitboard allowed = targets;
+    if (Bitboards::contains (pinned, from))
+      allowed &= Attacks::line (king, from);
+
+    /*pushes*/
+    int to = from + up;
+    if (!Bitboards::contains (occupied, to))
+    {
+      if (to / 8 == lastRank)
+      {
+        if (Bitboards::contains (allowed, to))
+          addPromotions (moves, from, to, type, false);
+      }
+      else if (type != Captures)
+      {
+        if (Bitboards::contains (allowed, to))
+          moves.add (Move (from, to));
+        if (from / 8 == startRank && !Bitboards::contains (occupied, to + up) && Bitboards::contains (allowed, to + up))
+          moves.add (Move (from, to + up));
+      }
+    }
+
+    /*captures*/
+    Bitboard captures = Attacks::pawn (us, from) & enemies & allowed;
+    while (captures)
+    {
+      to = Bitboards::popLsb (captures);
+      if (to / 8 == lastRank)
+        addPromotions (moves, from, to, type, true);
+      else if (type != Quiets)
+        moves.add (Move (from, to));
+    }
+
+    /*
+     * en passant. removing two pawns from the same rank can expose the king sideways, and the
+     * captured pawn might be the checker, so just look at what attacks the king afterwards.
+     */
+    int ep = p.getEnPassantSquare ();
+    if (type != Quiets && ep != PieceList::NO_SQUARE && Bitboards::contains (Attacks::pawn (us, from), ep))
+    {
+      int captured = ep - up;
+      Bitboard after = (occupied ^ Bitboards::bit (from) ^ Bitboards::bit (captured)) | Bitboards::bit (ep);
+      Bitboard attackers = attackersTo (p, king, after) & enemies & ~Bitboards::bit (captured);
+      if (!attackers)
+        moves.add (Move (from, ep, Move::EnPassant));
+    }
+  }
+}
+
+void MoveGenerator::generate (PieceList&p, MoveList&moves, GenType type)
+{
+  PieceList::Color us = p.getSideToMove ();
+  PieceList::Color them = (PieceList::Color) !us;
+  Bitboard occupied = p.getOccupied ();
+  Bitboard ours = p.getOccupancy (us);
+  Bitboard enemies = p.getOccupancy (them);
+  int king = p.getKingSquare (us);
+
+  Bitboard checkers = attackersTo (p, king, occupied) & enemies;
+
+  /*which squares moves may land on for this kind of generation*/
+  Bitboard typeTargets = type == All ? ~ours : type == Captures ? enemies : ~occupied;
+
+  /*king moves, looking through the king so it can't step back along a checking line*/
+  Bitboard withoutKing = occupied ^ Bitboards::bit (king);
+  Bitboard kingMoves = Attacks::king (king) & typeTargets;
+  while (kingMoves)
+  {
+    int to = Bitboards::popLsb (kingMoves);
+    if (!isAttacked (p, to, them, withoutKing))
+      moves.add (Move (king, to));
+  }
+
+  /*in double check only the king can move*/
+  if (Bitboards::moreThanOne (checkers))
+    return;
+
+  /*in single check, everything else has to capture the checker or block*/
+  Bitboard targets = ~ours;
+  if (checkers)
+  {
+    int checker = Bitboards::lsb (checkers);
+    targets = Attacks::between (king, checker) | checkers;
+  }
+
+  /*pinned pieces: ours, alone between the king and an enemy slider*/
+  Bitboard pinned = 0;
+  Bitboard snipers = (Attacks::rook (king, 0) & (p.getPieces (PieceList::Rook, them) | p.getPieces (PieceList::Queen, them))) |
+                     (Attacks::bishop (king, 0) & (p.getPieces (PieceList::Bishop, them) | p.getPieces (PieceList::Queen, them)));
+  while (snipers)
+  {
+    Bitboard b = Attacks::between (king, Bitboards::popLsb (snipers)) & occupied;
+    if (b && !Bitboards::moreThanOne (b) && (b & ours))
+      pinned |= b;
+  }
+
+  generatePawnMoves (p, moves, type, targets, pinned, king);
+
+  targets &= typeTargets;
+
+  /*pinned knights can never move*/
+  Bitboard knights = p.getPieces (PieceList::Knight, us) & ~pinned;
+  while (knights)
+  {
+    int from = Bitboards::popLsb (knights);
+    Bitboard b = Attacks::knight (from) & targets;
+    while (b)
+      moves.add (Move (from, Bitboards::popLsb (b)));
+  }
+
+  Bitboard queens = p.getPieces (PieceList::Queen, us);
+  Bitboard diagonals = p.getPieces (PieceList::Bishop, us) | queens;
+  while (diagonals)
+  {
+    int from = Bitboards::popLsb (diagonals);
+    Bitboard b = Attacks::bishop (from, occupied) & targets;
+    if (Bitboards::contains (pinned, from))
+      b &= Attacks::line (king, from);
+    while (b)
+      moves.add (Move (from, Bitboards::popLsb (b)));
+  }
+
+  Bitboard straights = p.getPieces (PieceList::Rook, us) | queens;
+  while (straights)
+  {
+    int from = Bitboards::popLsb (straights);
+    Bitboard b = Attacks::rook (from, occupied) & targets;
+    if (Bitboards::contains (pinned, from))
+      b &= Attacks::line (king, from);
+    while (b)
+      moves.add (Move (from, Bitboards::popLsb (b)));
+  }
+
+  /*
+   * castling: not out of check, the squares between king and rook empty and the squares
+   * the king crosses not attacked. the rights imply king and rook are on their home squares.
+   */
+  if (type != Captures && !checkers)
+  {
+    int rights = p.getCastlingRights ();
+    int kingside = us == PieceList::White ? PieceList::WhiteKingside : PieceList::BlackKingside;
+    int queenside = us == PieceList::White ? PieceList::WhiteQueenside : PieceList::BlackQueenside;
+
+    if ((rights & kingside) && !(occupied & (Bitboards::bit (king + 1) | Bitboards::bit (king + 2))) &&
+        !isAttacked (p, king + 1, them, occupied) && !isAttacked (p, king + 2, them, occupied))
+      moves.add (Move (king, king + 2, Move::Castling));
+
+    if ((rights & queenside) && !(occupied & (Bitboards::bit (king - 1) | Bitboards::bit (king - 2) | Bitboards::bit (king - 3))) &&
+        !isAttacked (p, king - 1, them, occupied) && !isAttacked (p, king - 2, them, occupied))
+      moves.add (Move (king, king - 2, Move::Castling));
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef MoveGenerator_h
+#define MoveGenerator_h
+
+#include "PieceList.h"
+#include "MoveList.h"
+
+/*
+ * legal move generation for the side to move in a PieceList. Attacks::init () has to
+ * have been called first.
+ *
+ * the generator works out checkers and pinned pieces up front so every move it emits is
+ * legal without having to play it and look for checks: in check only evasions are generated,
+ * pinned pieces only move along the pin line and the king never steps onto an attacked square.
+ * en passant, which can uncover a check along the rank, is the one move tested directly.
+ */
+
+class MoveGenerator
+{
+  public:
+  enum GenType
+  {
+    All,
+    Captures, //captures plus queen promotions
+    Quiets //everything that isn't in Captures
+  };
+
+  static void generate (PieceList&position, MoveList&moves, GenType type = All);
+  static Bitboard attackersTo (PieceList&position, int square, Bitboard occupied);
+  static bool isAttacked (PieceList&position, int square, PieceList::Color by, Bitboard occupied);
+  static bool inCheck (PieceList&position);
+
+  private:
+  static void generatePawnMoves (PieceList&position, MoveList&moves, GenType type, Bitboard targets, Bitboard pinned, int king);
+  static void addPromotions (MoveList&moves, int from, int to, GenType type, bool capture);
+};
+
+#endif // MoveGenerator_h
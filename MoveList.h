@@ -0,0 +1,67 @@
+#ifndef MoveList_h
+#define MoveList_h
+
+#include "Move.h"
+
+/*
+ * fixed capacity list of moves, meant to live on the stack of whatever is generating
+ * moves so that there's no allocation per node. 256 is more than the largest number of
+ * legal moves in any reachable position (218).
+ */
+
+class MoveList
+{
+  public:
+  enum
+  {
+    MAX_MOVES = 256
+  };
+
+  MoveList () : size (0)
+  {
+  }
+
+  void add (Move move)
+  {
+    moves [size++] = move;
+  }
+
+  int getSize ()
+  {
+    return size;
+  }
+
+  void clear ()
+  {
+    size = 0;
+  }
+
+  bool contains (Move move)
+  {
+    for (int i = 0; i < size; i++)
+      if (moves [i] == move)
+        return true;
+    return false;
+  }
+
+  Move&operator[] (int i)
+  {
+    return moves [i];
+  }
+
+  Move*begin ()
+  {
+    return moves;
+  }
+
+  Move*end ()
+  {
+    return moves + size;
+  }
+
+  private:
+  Move moves [MAX_MOVES];
+  int size;
+};
+
+#endif // MoveList_h
@@ -0,0 +1,306 @@
+#include <cstring>
+#include "Pgn.h"
+#include "MoveGenerator.h"
+#include "MoveList.h"
+#include "insist.h"
+
+static const char pieceLetters [] = "PNBRQK";
+
+void Pgn::Game::clear ()
+{
+  tags.clear ();
+  moves.clear ();
+  result.clear ();
+  error.clear ();
+}
+
+/*
+ * the value of tag name, empty if there isn't one
+ */
+
+std::string Pgn::Game::getTag (const std::string&name)
+{
+  for (auto&tag : tags)
+    if (tag.first == name)
+      return tag.second;
+  return "";
+}
+
+void Pgn::Game::setTag (const std::string&name, const std::string&value)
+{
+  for (auto&tag : tags)
+    if (tag.first == name)
+    {
+      tag.second = value;
+      return;
+    }
+  tags.push_back (std::make_pair (name, value));
+}
+
+/*
+ * set position up where the game starts, which is the FEN tag if there is one. returns
+ * false if the FEN doesn't parse.
+ */
+
+bool Pgn::Game::getStart (PieceList&position)
+{
+  std::string fen = getTag ("FEN");
+  if (fen.empty ())
+  {
+    position.reset ();
+    return true;
+  }
+  return position.setFen (fen);
+}
+
+static bool isCapture (PieceList&position, Move move)
+{
+  return position.getPiece (move.getTo ()) != PieceList::None || move.getType () == Move::EnPassant;
+}
+
+/*
+ * move, which has to be legal in position, in SAN. the piece is only told apart from others
+ * of its kind that could go to the same square by as much as it takes: file, rank, or both.
+ */
+
+std::string Pgn::toSan (PieceList&position, Move move)
+{
+  std::string san;
+  int from = move.getFrom (), to = move.getTo ();
+  PieceList::PieceType type = PieceList::getType (position.getPiece (from));
+
+  if (move.getType () == Move::Castling)
+    san = to > from ? "O-O" : "O-O-O";
+  else
+  {
+    if (type == PieceList::Pawn)
+    {
+      if (isCapture (position, move))
+        san += (char) ('a' + from % 8);
+    }
+    else
+    {
+      san += pieceLetters [type];
+
+      MoveList moves;
+      MoveGenerator::generate (position, moves);
+      bool ambiguous = false, sameFile = false, sameRank = false;
+      for (Move m : moves)
+        if (m.getTo () == to && m.getFrom () != from && PieceList::getType (position.getPiece (m.getFrom ())) == type)
+        {
+          ambiguous = true;
+          sameFile |= m.getFrom () % 8 == from % 8;
+          sameRank |= m.getFrom () / 8 == from / 8;
+        }
+
+      if (ambiguous)
+      {
+        if (!sameFile || sameRank)
+          san += (char) ('a' + from % 8);
+        if (sameFile)
+          san += (char) ('1' + from / 8);
+      }
+    }
+
+    if (isCapture (position, move))
+      san += 'x';
+    san += (char) ('a' + to % 8);
+    san += (char) ('1' + to / 8);
+    if (move.getType () == Move::Promotion)
+    {
+      san += '=';
+      san += pieceLetters [move.getPromotion ()];
+    }
+  }
+
+  position.makeMove (move);
+  if (MoveGenerator::inCheck (position))
+  {
+    MoveList replies;
+    MoveGenerator::generate (position, replies);
+    san += replies.getSize () ? '+' : '#';
+  }
+  position.unmakeMove ();
+  return san;
+}
+
+/*
+ * the legal move in position that san, length characters long, stands for, or a null move if
+ * there isn't exactly one. check marks and annotations on the end are ignored, and so is a
+ * missing = before a promotion or 0-0 for O-O.
+ */
+
+Move Pgn::fromSan (PieceList&position, const char*san, size_t length)
+{
+  while (length > 0 && strchr ("+#!?", san [length - 1]))
+    length--;
+  if (length < 2)
+    return Move ();
+
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+
+  if (san [0] == 'O' || san [0] == '0')
+  {
+    bool kingside = length == 3;
+    if (!kingside && length != 5)
+      return Move ();
+    for (Move m : moves)
+      if (m.getType () == Move::Castling && (m.getTo () > m.getFrom ()) == kingside)
+        return m;
+    return Move ();
+  }
+
+  size_t i = 0;
+  int type = PieceList::Pawn;
+  const char*letter = strchr (pieceLetters + 1, san [0]);
+  if (letter && *letter)
+  {
+    type = (int) (letter - pieceLetters);
+    i++;
+  }
+
+  /*a promotion is the last thing, with or without an =*/
+  int promotion = 0;
+  if (type == PieceList::Pawn && length > i + 2)
+  {
+    letter = strchr (pieceLetters + 1, san [length - 1]);
+    if (letter && *letter && *letter != 'K')
+    {
+      promotion = (int) (letter - pieceLetters);
+      length -= san [length - 2] == '=' ? 2 : 1;
+    }
+  }
+
+  /*the destination comes right before that*/
+  if (length < i + 2)
+    return Move ();
+  char toFile = san [length - 2], toRank = san [length - 1];
+  if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8')
+    return Move ();
+  int to = (toRank - '1') * 8 + (toFile - 'a');
+
+  /*anything in between says where the piece comes from*/
+  int fromFile = -1, fromRank = -1;
+  for (size_t j = i; j < length - 2; j++)
+  {
+    char c = san [j];
+    if (c >= 'a' && c <= 'h')
+      fromFile = c - 'a';
+    else if (c >= '1' && c <= '8')
+      fromRank = c - '1';
+    else if (c != 'x' && c != '-' && c != ':')
+      return Move ();
+  }
+
+  Move found;
+  for (Move m : moves)
+  {
+    if (m.getTo () != to || PieceList::getType (position.getPiece (m.getFrom ())) != type)
+      continue;
+    if ((fromFile >= 0 && m.getFrom () % 8 != fromFile) || (fromRank >= 0 && m.getFrom () / 8 != fromRank))
+      continue;
+    if (m.getType () == Move::Promotion ? m.getPromotion () != promotion : promotion != 0)
+      continue;
+    if (!found.isNull ())
+      return Move ();
+    found = m;
+  }
+  return found;
+}
+
+/*
+ * the result if the game is over on the board, by mate, stalemate or the fifty move rule,
+ * and * if it's still going
+ */
+
+std::string Pgn::getResult (PieceList&position)
+{
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+
+  if (moves.getSize () == 0 && MoveGenerator::inCheck (position))
+    return position.getSideToMove () == PieceList::White ? "0-1" : "1-0";
+  if (moves.getSize () == 0 || position.getHalfmoveClock () >= 100)
+    return "1/2-1/2";
+  return "*";
+}
+
+/*
+ * [name "value"], with any " or \ in value escaped
+ */
+
+static void writeTag (std::ostream&out, const std::string&name, const std::string&value)
+{
+  out << "[" << name << " \"";
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+  out << "\"]\n";
+}
+
+/*
+ * game in PGN: the seven tags every game is supposed to have first, then any others, then the
+ * moves, numbered and wrapped to fit in 80 columns. a game that doesn't end with its result
+ * gets * for one.
+ */
+
+void Pgn::write (std::ostream&out, Game&game)
+{
+  static const char*roster [][2] = {{"Event", "?"}, {"Site", "?"}, {"Date", "????.??.??"}, {"Round", "?"},
+                                    {"White", "?"}, {"Black", "?"}, {"Result", "*"}};
+  std::string result = game.result.empty () ? game.getTag ("Result") : game.result;
+  if (result.empty ())
+    result = "*";
+
+  for (auto&tag : roster)
+  {
+    std::string value = strcmp (tag [0], "Result") == 0 ? result : game.getTag (tag [0]);
+    writeTag (out, tag [0], value.empty () ? tag [1] : value);
+  }
+
+  for (auto&tag : game.tags)
+  {
+    bool inRoster = false;
+    for (auto&r : roster)
+      inRoster |= tag.first == r [0];
+    if (!inRoster)
+      writeTag (out, tag.first, tag.second);
+  }
+  out << "\n";
+
+  PieceList position;
+  bool started = game.getStart (position);
+  insist (started);
+
+  std::string line;
+  bool first = true;
+  for (Move move : game.moves)
+  {
+    std::string text;
+    if (position.getSideToMove () == PieceList::White)
+      text = std::to_string (position.getFullmoveNumber ()) + ". ";
+    else if (first)
+      text = std::to_string (position.getFullmoveNumber ()) + "... ";
+    text += toSan (position, move);
+    position.makeMove (move);
+    first = false;
+
+    if (line.size () + 1 + text.size () > 79)
+    {
+      out << line << "\n";
+      line.clear ();
+    }
+    line += (line.empty () ? "" : " ") + text;
+  }
+
+  if (line.size () + 1 + result.size () > 79)
+  {
+    out << line << "\n";
+    line.clear ();
+  }
+  out << line << (line.empty () ? "" : " ") << result << "\n\n";
+}
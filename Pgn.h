@@ -0,0 +1,43 @@
+#ifndef Pgn_h
+#define Pgn_h
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PieceList.h"
+#include "Move.h"
+
+/*
+ * PGN, the text format games are stored and passed around in. a game is a list of tag
+ * pairs ([White "Fischer, Robert J."]) and then the moves in SAN (Nf3, exd5, O-O, e8=Q+)
+ * ending with the result.
+ *
+ * Game is one game, moves already turned into Moves. PgnReader reads them out of files,
+ * write puts them back. SAN is converted both ways through the move generator, so a SAN
+ * move that comes out of fromSan is legal.
+ */
+
+class Pgn
+{
+  public:
+  struct Game
+  {
+    std::vector<std::pair<std::string, std::string>>tags; //in the order they came in
+    std::vector<Move>moves;
+    std::string result; //1-0, 0-1, 1/2-1/2 or *
+    std::string error; //why moves stops short of the whole game, empty if it doesn't
+
+    void clear ();
+    std::string getTag (const std::string&name);
+    void setTag (const std::string&name, const std::string&value);
+    bool getStart (PieceList&position);
+  };
+
+  static std::string toSan (PieceList&position, Move move);
+  static Move fromSan (PieceList&position, const char*san, size_t length);
+  static std::string getResult (PieceList&position);
+  static void write (std::ostream&out, Game&game);
+};
+
+#endif // Pgn_h
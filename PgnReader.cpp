@@ -0,0 +1,246 @@
+#include <cstring>
+#include <mutex>
+#include "PgnReader.h"
+#include "insist.h"
+
+/*what each byte is to the tokenizer, so scanning is a table lookup per byte*/
+enum
+{
+  SPACE = 1,
+  DELIMITER = 2 //ends a symbol
+};
+
+static unsigned char charClass [256];
+
+static void initCharClasses ()
+{
+  for (const char*c = " \n\r\t\f\v"; *c; c++)
+    charClass [(unsigned char) *c] = SPACE | DELIMITER;
+  for (const char*c = "{}();[$"; *c; c++)
+    charClass [(unsigned char) *c] = DELIMITER;
+}
+
+static bool isSpace (char c)
+{
+  return charClass [(unsigned char) c] & SPACE;
+}
+
+PgnReader::PgnReader () : begin (0), end (0), p (0)
+{
+  static std::once_flag once;
+  std::call_once (once, initCharClasses);
+}
+
+/*
+ * open a PGN file, returns false if it can't be opened
+ */
+
+bool PgnReader::open (std::string path)
+{
+  close ();
+  if (!file.open (path, MappedFile::Sequential))
+    return false;
+
+  begin = p = (const char*) file.getData ();
+  end = begin + file.getSize ();
+
+  /*skip a UTF-8 byte order mark*/
+  if (end - p >= 3 && memcmp (p, "\xEF\xBB\xBF", 3) == 0)
+    p += 3;
+  return true;
+}
+
+void PgnReader::close ()
+{
+  file.close ();
+  begin = end = p = 0;
+}
+
+/*
+ * skip everything that isn't a token: white space, comments, % lines, NAGs ($12) and
+ * variations in parentheses, which can nest and have comments of their own
+ */
+
+void PgnReader::skipSpace ()
+{
+  int depth = 0; //how many variations we're inside
+
+  while (p < end)
+  {
+    char c = *p;
+    if (isSpace (c))
+      p++;
+    else if (c == '{')
+    {
+      const char*close = (const char*) memchr (p, '}', end - p);
+      p = close ? close + 1 : end;
+    }
+    else if (c == ';' || (c == '%' && (p == begin || p [-1] == '\n')))
+    {
+      const char*newline = (const char*) memchr (p, '\n', end - p);
+      p = newline ? newline + 1 : end;
+    }
+    else if (c == '(')
+    {
+      depth++;
+      p++;
+    }
+    else if (c == ')' && depth > 0)
+    {
+      depth--;
+      p++;
+    }
+    else if (c == '$')
+    {
+      for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+        ;
+    }
+    else if (depth > 0)
+      p++;
+    else
+      break;
+  }
+}
+
+/*
+ * [Name "value"] at p. the value can have \" and \\ in it. a malformed tag is skipped to
+ * the end of its line and false returned.
+ */
+
+bool PgnReader::readTag (Pgn::Game&game)
+{
+  insist (p < end && *p == '[');
+
+  const char*line = (const char*) memchr (p, '\n', end - p);
+  if (!line)
+    line = end;
+
+  for (p++; p < line && isSpace (*p); p++)
+    ;
+  const char*name = p;
+  while (p < line && !isSpace (*p) && *p != '"' && *p != ']')
+    p++;
+  size_t nameLength = p - name;
+  while (p < line && isSpace (*p))
+    p++;
+
+  if (nameLength == 0 || p == line || *p != '"')
+  {
+    p = line;
+    return false;
+  }
+
+  std::string value;
+  for (p++; p < line && *p != '"'; p++)
+  {
+    if (*p == '\\' && p + 1 < line)
+      p++;
+    value += *p;
+  }
+
+  const char*close = (const char*) memchr (p, ']', line - p);
+  p = close ? close + 1 : line;
+  game.tags.push_back (std::make_pair (std::string (name, nameLength), value));
+  return close != 0;
+}
+
+/*
+ * the next token in the moves. a move number is digits and dots (12. or 12...), which can run
+ * straight into the move after it. 0-0 is a move, not a result.
+ */
+
+PgnReader::Token PgnReader::nextToken ()
+{
+  skipSpace ();
+
+  Token token = {End, p, 0};
+  if (p == end)
+    return token;
+
+  if (*p == '[')
+  {
+    token.type = TagStart;
+    return token;
+  }
+
+  const char*start = p;
+  if (*p >= '0' && *p <= '9')
+  {
+    while (p < end && *p >= '0' && *p <= '9')
+      p++;
+    if (p < end && *p == '.')
+    {
+      while (p < end && *p == '.')
+        p++;
+      token.type = MoveNumber;
+      token.length = p - start;
+      return token;
+    }
+  }
+
+  while (p < end && !(charClass [(unsigned char) *p] & DELIMITER))
+    p++;
+  if (p == start)
+    p++; //a stray } or ), skip it
+  token.length = p - start;
+
+  static const char*results [] = {"1-0", "0-1", "1/2-1/2", "*"};
+  token.type = Symbol;
+  for (const char*r : results)
+    if (token.length == strlen (r) && memcmp (start, r, token.length) == 0)
+      token.type = Result;
+  return token;
+}
+
+/*
+ * read the next game into game, returns false at the end of the file. a game with a move
+ * that doesn't parse or isn't legal still comes back, with the moves up to there and error
+ * saying what went wrong.
+ */
+
+bool PgnReader::next (Pgn::Game&game, bool moves)
+{
+  game.clear ();
+  skipSpace ();
+  if (p >= end)
+    return false;
+
+  while (p < end && *p == '[')
+  {
+    readTag (game);
+    skipSpace ();
+  }
+
+  bool playing = moves;
+  if (playing && !game.getStart (position))
+  {
+    game.error = "bad FEN " + game.getTag ("FEN");
+    playing = false;
+  }
+
+  while (true)
+  {
+    Token token = nextToken ();
+    if (token.type == End || token.type == TagStart)
+      break;
+    if (token.type == Result)
+    {
+      game.result.assign (token.text, token.length);
+      break;
+    }
+    if (token.type != Symbol || !playing)
+      continue;
+
+    Move move = Pgn::fromSan (position, token.text, token.length);
+    if (move.isNull ())
+    {
+      game.error = "illegal move " + std::string (token.text, token.length) + " at ply " +
+                   std::to_string (game.moves.size () + 1);
+      playing = false;
+      continue;
+    }
+    game.moves.push_back (move);
+    position.makeMove (move);
+  }
+  return true;
+}
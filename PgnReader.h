@@ -0,0 +1,68 @@
+#ifndef PgnReader_h
+#define PgnReader_h
+
+#include <string>
+#include "MappedFile.h"
+#include "Pgn.h"
+
+/*
+ * reads the games in a PGN file one after another. the file is mapped, not read, and parsed
+ * in place: tokens are just where they start in the mapping and how long they are, and the
+ * only copies made are what goes into the Game. so a database of any size streams through in
+ * one pass at about the speed the disk can give it, with nothing held on to but the current
+ * game. reusing one Game for every call to next keeps even that from allocating once its
+ * vectors and strings have grown to fit.
+ *
+ * with moves false, next only reads the tags and skips over the moves without playing them,
+ * which is a lot faster, for finding games in a big file.
+ */
+
+class PgnReader
+{
+  public:
+  PgnReader ();
+  bool open (std::string path);
+  void close ();
+  bool next (Pgn::Game&game, bool moves = true);
+
+  /*how far into the file the next game starts, for showing progress*/
+  size_t getOffset ()
+  {
+    return (size_t) (p - begin);
+  }
+
+  size_t getSize ()
+  {
+    return (size_t) (end - begin);
+  }
+
+  private:
+  enum TokenType
+  {
+    End,
+    Symbol, //a move, or something unknown
+    MoveNumber,
+    Result,
+    TagStart //a [ starting a line, which is the next game
+  };
+
+  /*a token in the file, not copied out*/
+  struct Token
+  {
+    TokenType type;
+    const char*text;
+    size_t length;
+  };
+
+  MappedFile file;
+  const char*begin;
+  const char*end;
+  const char*p;
+  PieceList position; //for playing the moves, kept so its history isn't allocated per game
+
+  void skipSpace ();
+  bool readTag (Pgn::Game&game);
+  Token nextToken ();
+};
+
+#endif // PgnReader_h
@@ -1,28 +1,29 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsScene>
 #include "PieceGraphicsItem.h"
+#include "PixmapCache.h"
 #include "insist.h"
 
 /*
  * Class to handle displaying chess pieces on the board, remembering what square the chess piece is on,
  * and dealing with changing the size of the piece and whether it's shown with a shadow or not.
  *
- * QPixmap is one of qt's "shared objects" so it doesn't allocate tons of memory when it's copied and
- * this class goes along with qt's idiom on this and only deals with references to them, not pointers.
- * this simplifies the memory management.
+ * the pixmaps come from the PixmapCache, which scales each piece once per size for every board.
+ * QPixmap is one of qt's "shared objects" so it doesn't allocate tons of memory when it's copied,
+ * so the item just keeps a copy of the one it's showing.
  *
  * all of the pixmaps are assumed to be square, this matters for scaling.
  *
  */
 
-PieceGraphicsItem::PieceGraphicsItem (int size, int boardIndex, QPixmap&plainPixmap, QPixmap&shadowPixmap):
-  plainPixmap (plainPixmap),
-  shadowPixmap (shadowPixmap)
+PieceGraphicsItem::PieceGraphicsItem (int size, int boardIndex, PieceList::Piece piece)
 {
   insist (size > 0 && boardIndex >= 0 && boardIndex < 64);
+  insist (piece >= PieceList::wPawn && piece < PieceList::None);
 
   this->size = size;
   this->boardIndex = boardIndex;
+  this->piece = piece;
 
   /*set the initial pixmap*/
   resetPixmap ();
@@ -30,22 +31,19 @@ PieceGraphicsItem::PieceGraphicsItem (int size, int boardIndex, QPixmap&plainPix
 
 
 /*
- * create a new shaded or normal pixmap of the current size and set the QGraphicsPixmapItem baseclass's pixmap with it.
+ * set the QGraphicsPixmapItem baseclass's pixmap to the shaded or normal pixmap of the current size.
  * this is called internally whenever the size or the shadow state changes.
  */
 void PieceGraphicsItem::resetPixmap ()
 {
   insist (size > 0);
 
-  if (shadow)
-    setPixmap (shadowPixmap.scaledToWidth (size, Qt::SmoothTransformation));
-  else
-    setPixmap (plainPixmap.scaledToWidth (size, Qt::SmoothTransformation));
+  setPixmap (PixmapCache::instance ()->getPixmap (piece, shadow, size));
 }
 
 /*
  * change the shadow state of the piece. this will result in a new pixmap
- * being created in order to effect the actual visual change. shaded pieces
+ * being set in order to effect the actual visual change. shaded pieces
  * are also set so their z-order is topmost. when they become unshaded
  * then their z-order is bottommost.
  */
@@ -2,6 +2,7 @@
 #define PieceGraphicsItem_h
 
 #include <QGraphicsPixmapItem>
+#include "PieceList.h"
 #include "insist.h"
 
 class PieceGraphicsItem : public QObject, public QGraphicsPixmapItem
@@ -10,7 +11,7 @@ class PieceGraphicsItem : public QObject, public QGraphicsPixmapItem
   Q_PROPERTY (QPointF pos READ pos WRITE setPos)
 
   public:
-  PieceGraphicsItem (int size, int boardIndex, QPixmap&plainPixmap, QPixmap&shadowPixmap);
+  PieceGraphicsItem (int size, int boardIndex, PieceList::Piece piece);
   void setShadow (bool shaded);
   void setSize (int size);
 
@@ -22,9 +23,8 @@ class PieceGraphicsItem : public QObject, public QGraphicsPixmapItem
   };
   int size;
   int boardIndex;
+  PieceList::Piece piece;
   QPointF buttonDownPos;
-  QPixmap plainPixmap;
-  QPixmap shadowPixmap;
   bool shadow = false;
   void resetPixmap ();
 
@@ -34,9 +34,14 @@ class PieceGraphicsItem : public QObject, public QGraphicsPixmapItem
     return boardIndex;
   }
 
+  PieceList::Piece getPiece ()
+  {
+    return piece;
+  }
+
   void setBoardIndex (int boardIndex)
   {
-    insist (boardIndex >= 0 && boardIndex < 64);
+    hotInsist (boardIndex >= 0 && boardIndex < 64);
     this->boardIndex = boardIndex;
   }
   protected:
@@ -1,36 +1,89 @@
+#include <algorithm>
+#include <sstream>
 #include "PieceList.h"
+#include "MoveGenerator.h"
+
+/*
+ * PieceList is the position. It keeps one bitboard per piece plus occupancy sets for
+ * the engine, and a plain 64 square array alongside them so that getPiece stays a single
+ * lookup for the UI code. putPiece, removePiece and movePiece are the only way pieces get on or
+ * off the board so the two representations, the Zobrist key and the piece-square score can't
+ * drift apart, and so the score is kept up incrementally through makeMove and unmakeMove.
+ *
+ * makeMove/unmakeMove work in place, pushing what can't be recomputed onto history, which
+ * also gives the keys of earlier positions for spotting repetitions.
+ */
 
 PieceList::PieceList()
 {
+  Zobrist::init ();
+  Psqt::init ();
+
+  history.reserve (HISTORY_RESERVE);
   reset ();
 }
 
+/*
+ * the searches work on copies, and a copied vector only gets the capacity it needs, so
+ * both of these keep the reserve. a new member has to be added to operator= as well.
+ */
+PieceList::PieceList (const PieceList&other)
+{
+  history.reserve (HISTORY_RESERVE);
+  *this = other;
+}
+
+PieceList&PieceList::operator= (const PieceList&other)
+{
+  if (this == &other)
+    return *this;
+  std::copy (other.squares, other.squares + 64, squares);
+  std::copy (other.pieces, other.pieces + 12, pieces);
+  std::copy (other.occupancy, other.occupancy + 2, occupancy);
+  occupied = other.occupied;
+  sideToMove = other.sideToMove;
+  castlingRights = other.castlingRights;
+  enPassantSquare = other.enPassantSquare;
+  halfmoveClock = other.halfmoveClock;
+  fullmoveNumber = other.fullmoveNumber;
+  key = other.key;
+  psq = other.psq;
+  history.reserve (HISTORY_RESERVE);
+  history.assign (other.history.begin (), other.history.end ());
+  return *this;
+}
+
 void PieceList::setPiece (int rank, int file, Piece piece)
 {
-  insist (rank >= 0 && rank < 8);
-  insist (file >= 0 && file < 8);
+  hotInsist (rank >= 0 && rank < 8);
+  hotInsist (file >= 0 && file < 8);
 
-  squares [rank * 8 + file] = piece;
+  setPiece (rank * 8 + file, piece);
 }
 
 void PieceList::setPiece (int boardIndex, Piece piece)
 {
-  insist (boardIndex >= 0 && boardIndex < 64);
+  hotInsist (boardIndex >= 0 && boardIndex < 64);
+  hotInsist (piece >= wPawn && piece <= None);
 
-  squares [boardIndex] = piece;
+  /*take off whatever was there*/
+  if (squares [boardIndex] != None)
+    removePiece (boardIndex);
+  if (piece != None)
+    putPiece (boardIndex, piece);
 }
 
 PieceList::Piece PieceList::getPiece (int rank, int file)
 {
-  insist (rank >= 0 && rank < 8);
-  insist (file >= 0 && file < 8);
+  hotInsist (rank >= 0 && rank < 8);
+  hotInsist (file >= 0 && file < 8);
 
   return squares [rank * 8 + file];
 }
 
 PieceList::Piece PieceList::getPiece (int boardIndex)
 {
-  insist (boardIndex >= 0 && boardIndex < 64);
+  hotInsist (boardIndex >= 0 && boardIndex < 64);
   return squares [boardIndex];
 }
 /*
@@ -50,30 +103,462 @@ PieceList::Piece PieceList::other (Piece piece)
 }
 
 /*
- * set the board to represent a newly set up game
+ * empty the board
  */
 
-void PieceList::reset ()
+void PieceList::clear ()
 {
   for (int i = 0; i < 64; i++)
     squares [i] = None;
+  for (int i = 0; i < 12; i++)
+    pieces [i] = 0;
+  occupancy [White] = occupancy [Black] = 0;
+  occupied = 0;
+  sideToMove = White;
+  castlingRights = 0;
+  enPassantSquare = NO_SQUARE;
+  halfmoveClock = 0;
+  fullmoveNumber = 1;
+  key = 0;
+  psq = 0;
+  history.clear ();
+}
+
+/*
+ * the Zobrist key worked out from scratch
+ */
+
+Bitboard PieceList::computeKey ()
+{
+  Bitboard k = 0;
+  for (int i = 0; i < 64; i++)
+    if (squares [i] != None)
+      k ^= Zobrist::piece (squares [i], i);
+
+  k ^= Zobrist::castling (castlingRights);
+  if (enPassantSquare != NO_SQUARE)
+    k ^= Zobrist::enPassant (enPassantSquare);
+  if (sideToMove == Black)
+    k ^= Zobrist::side ();
+  return k;
+}
+
+/*
+ * set the board to represent a newly set up game
+ */
+
+void PieceList::reset ()
+{
+  clear ();
 
   /*white side*/
-  squares [0] = wRook;
-  squares [1] = wBishop;
-  squares [2] = wKnight;
-  squares [3] = wKing;
-  squares [4] = wQueen;
-  squares [5] = squares [2]; //symmetric
-  squares [6] = squares [1];
-  squares [7] = squares [0];
-
-  for (int i = 8; i < 16; i++)
-    squares [i] = wPawn;
+  Piece backRank [8] = {wRook, wKnight, wBishop, wQueen, wKing, wBishop, wKnight, wRook};
+  for (int i = 0; i < 8; i++)
+  {
+    setPiece (i, backRank [i]);
+    setPiece (i + 8, wPawn);
+  }
 
   /*black side mirrors white side*/
   for (int i = 0; i < 8; i++)
-    squares [i + 48] = other (squares [i + 8]);
-  for (int i = 0; i < 8; i++)
-    squares [i + 56] = other (squares [i + 0]);
+  {
+    setPiece (i + 48, bPawn);
+    setPiece (i + 56, other (backRank [i]));
+  }
+  castlingRights = WhiteKingside | WhiteQueenside | BlackKingside | BlackQueenside;
+  key = computeKey ();
+}
+
+/*
+ * set up the position described by a FEN string. the move clocks are optional.
+ * returns false, leaving the board in some unspecified state, if fen doesn't parse or isn't
+ * a position that could come up: pawns on the back ranks, or the side not to move in check.
+ */
+
+bool PieceList::setFen (std::string fen)
+{
+  std::istringstream in (fen);
+  std::string board, side, castling, enPassant;
+  in >> board >> side >> castling >> enPassant;
+
+  clear ();
+
+  /*the board is given rank 8 first, a file first*/
+  std::string letters = "PpNnBbRrQqKk";
+  int rank = 7, file = 0;
+  for (char c : board)
+  {
+    if (c == '/')
+    {
+      if (file != 8 || --rank < 0)
+        return false;
+      file = 0;
+    }
+    else if (c >= '1' && c <= '8')
+      file += c - '0';
+    else
+    {
+      size_t piece = letters.find (c);
+      if (piece == std::string::npos || file > 7)
+        return false;
+      setPiece (rank, file++, (Piece) piece);
+    }
+    if (file > 8)
+      return false;
+  }
+  if (rank != 0 || file != 8 || count (wKing) != 1 || count (bKing) != 1)
+    return false;
+
+  /*pawns can't be on the first or last rank*/
+  if ((pieces [wPawn] | pieces [bPawn]) & 0xff000000000000ffULL)
+    return false;
+
+  if (side != "w" && side != "b")
+    return false;
+  sideToMove = side == "w" ? White : Black;
+
+  for (char c : castling)
+  {
+    switch (c)
+    {
+      case 'K': castlingRights |= WhiteKingside; break;
+      case 'Q': castlingRights |= WhiteQueenside; break;
+      case 'k': castlingRights |= BlackKingside; break;
+      case 'q': castlingRights |= BlackQueenside; break;
+      case '-': break;
+      default: return false;
+    }
+  }
+
+  /*drop rights that the pieces say are gone, so makeMove can trust the rights*/
+  if (squares [4] != wKing)
+    castlingRights &= ~(WhiteKingside | WhiteQueenside);
+  if (squares [7] != wRook)
+    castlingRights &= ~WhiteKingside;
+  if (squares [0] != wRook)
+    castlingRights &= ~WhiteQueenside;
+  if (squares [60] != bKing)
+    castlingRights &= ~(BlackKingside | BlackQueenside);
+  if (squares [63] != bRook)
+    castlingRights &= ~BlackKingside;
+  if (squares [56] != bRook)
+    castlingRights &= ~BlackQueenside;
+
+  if (enPassant.size () == 2 && enPassant [0] >= 'a' && enPassant [0] <= 'h' && (enPassant [1] == '3' || enPassant [1] == '6'))
+  {
+    /*same rule as makeMove, only keep it if a pawn can actually take*/
+    int square = (enPassant [1] - '1') * 8 + enPassant [0] - 'a';
+    int pawn = sideToMove == White ? square - 8 : square + 8;
+    int pawnRank = sideToMove == White ? 4 : 3;
+    Piece ours = makePiece (Pawn, sideToMove);
+    if (pawn / 8 == pawnRank && squares [pawn] == other (ours) &&
+        ((pawn % 8 > 0 && squares [pawn - 1] == ours) || (pawn % 8 < 7 && squares [pawn + 1] == ours)))
+      enPassantSquare = square;
+  }
+  else if (enPassant != "-")
+    return false;
+
+  if (!(in >> halfmoveClock))
+    halfmoveClock = 0;
+  if (!(in >> fullmoveNumber))
+    fullmoveNumber = 1;
+  key = computeKey ();
+
+  /*the side that just moved can't have left its king in check*/
+  Color them = (Color) !sideToMove;
+  return !MoveGenerator::isAttacked (*this, getKingSquare (them), sideToMove, occupied);
+}
+
+/*
+ * the position as a FEN string, the inverse of setFen. the en passant square is only given
+ * when a pawn can actually take there, as setFen and makeMove keep it.
+ */
+
+std::string PieceList::getFen ()
+{
+  std::string fen;
+  const char*letters = "PpNnBbRrQqKk";
+
+  for (int rank = 7; rank >= 0; rank--)
+  {
+    int empty = 0;
+    for (int file = 0; file < 8; file++)
+    {
+      Piece piece = squares [rank * 8 + file];
+      if (piece == None)
+        empty++;
+      else
+      {
+        if (empty)
+          fen += (char) ('0' + empty);
+        empty = 0;
+        fen += letters [piece];
+      }
+    }
+    if (empty)
+      fen += (char) ('0' + empty);
+    if (rank > 0)
+      fen += '/';
+  }
+
+  fen += sideToMove == White ? " w " : " b ";
+  if (castlingRights & WhiteKingside)
+    fen += 'K';
+  if (castlingRights & WhiteQueenside)
+    fen += 'Q';
+  if (castlingRights & BlackKingside)
+    fen += 'k';
+  if (castlingRights & BlackQueenside)
+    fen += 'q';
+  if (!castlingRights)
+    fen += '-';
+
+  if (enPassantSquare == NO_SQUARE)
+    fen += " -";
+  else
+  {
+    fen += ' ';
+    fen += (char) ('a' + enPassantSquare % 8);
+    fen += (char) ('1' + enPassantSquare / 8);
+  }
+
+  return fen + " " + std::to_string (halfmoveClock) + " " + std::to_string (fullmoveNumber);
+}
+
+/*
+ * the castling rights that survive a move touching square, either moving from it or
+ * capturing on it.
+ */
+
+static int castlingMask (int square)
+{
+  switch (square)
+  {
+    case 0: return ~PieceList::WhiteQueenside;
+    case 4: return ~(PieceList::WhiteKingside | PieceList::WhiteQueenside);
+    case 7: return ~PieceList::WhiteKingside;
+    case 56: return ~PieceList::BlackQueenside;
+    case 60: return ~(PieceList::BlackKingside | PieceList::BlackQueenside);
+    case 63: return ~PieceList::BlackKingside;
+    default: return ~0;
+  }
+}
+
+/*
+ * in a checked build (DRB_CHECKED, see engine.pri), work everything that's kept incrementally
+ * out again from the mailbox and insist it's the same: the bitboards, the key, the piece-square
+ * score, and that the castling rights and en passant square make sense for the pieces. it's
+ * called after every make and unmake, so a bug there is caught on the move that caused it
+ * rather than as a bad move some time later. in other builds it's empty.
+ */
+
+void PieceList::checkInvariants ()
+{
+#if defined(DRB_CHECKED)
+  Bitboard boards [12] = {}, colors [2] = {};
+  Score score = 0;
+  for (int i = 0; i < 64; i++)
+  {
+    Piece piece = squares [i];
+    insist (piece >= wPawn && piece <= None);
+    if (piece == None)
+      continue;
+    boards [piece] |= Bitboards::bit (i);
+    colors [getColor (piece)] |= Bitboards::bit (i);
+    score += Psqt::piece (piece, i);
+  }
+
+  for (int piece = wPawn; piece < None; piece++)
+    insist (pieces [piece] == boards [piece]);
+  insist (occupancy [White] == colors [White] && occupancy [Black] == colors [Black]);
+  insist (occupied == (colors [White] | colors [Black]));
+  insist (count (wKing) == 1 && count (bKing) == 1);
+  insist (key == computeKey ());
+  insist (psq == score);
+
+  if (castlingRights & (WhiteKingside | WhiteQueenside))
+    insist (squares [4] == wKing);
+  if (castlingRights & (BlackKingside | BlackQueenside))
+    insist (squares [60] == bKing);
+  insist (!(castlingRights & WhiteKingside) || squares [7] == wRook);
+  insist (!(castlingRights & WhiteQueenside) || squares [0] == wRook);
+  insist (!(castlingRights & BlackKingside) || squares [63] == bRook);
+  insist (!(castlingRights & BlackQueenside) || squares [56] == bRook);
+
+  /*the square a pawn just passed over, so on the third rank from the side that moved*/
+  if (enPassantSquare != NO_SQUARE)
+    insist (enPassantSquare / 8 == (sideToMove == Black ? 2 : 5) && squares [enPassantSquare] == None);
+  insist (halfmoveClock >= 0);
+#endif
+}
+
+/*
+ * play move, which has to be legal, updating the pieces, the rest of the game state and the key.
+ */
+
+void PieceList::makeMove (Move move)
+{
+  int from = move.getFrom ();
+  int to = move.getTo ();
+  Piece piece = squares [from];
+  Piece captured = squares [to];
+  hotInsist (piece != None && getColor (piece) == sideToMove);
+
+  history.push_back ({move, captured, castlingRights, enPassantSquare, halfmoveClock, key});
+
+  if (enPassantSquare != NO_SQUARE)
+    key ^= Zobrist::enPassant (enPassantSquare);
+
+  halfmoveClock++;
+  if (getType (piece) == Pawn || captured != None)
+    halfmoveClock = 0;
+
+  switch (move.getType ())
+  {
+    case Move::Castling:
+      /*the rook goes from the corner to the square the king passed over*/
+      movePiece (from, to);
+      movePiece (to > from ? from + 3 : from - 4, (from + to) / 2);
+      break;
+    case Move::EnPassant:
+    {
+      int square = sideToMove == White ? to - 8 : to + 8;
+      history.back ().captured = squares [square];
+      removePiece (square);
+      movePiece (from, to);
+      break;
+    }
+    case Move::Promotion:
+      if (captured != None)
+        removePiece (to);
+      removePiece (from);
+      putPiece (to, makePiece ((PieceType) move.getPromotion (), sideToMove));
+      break;
+    default:
+      if (captured != None)
+        removePiece (to);
+      movePiece (from, to);
+  }
+
+  int rights = castlingRights & castlingMask (from) & castlingMask (to);
+  if (rights != castlingRights)
+  {
+    key ^= Zobrist::castling (castlingRights) ^ Zobrist::castling (rights);
+    castlingRights = rights;
+  }
+
+  /*only remember the en passant square if there's an enemy pawn next to the one that just moved*/
+  enPassantSquare = NO_SQUARE;
+  if (getType (piece) == Pawn && (to - from == 16 || from - to == 16))
+  {
+    Bitboard neighbours = 0;
+    if (to % 8 > 0)
+      neighbours |= Bitboards::bit (to - 1);
+    if (to % 8 < 7)
+      neighbours |= Bitboards::bit (to + 1);
+    if (neighbours & pieces [makePiece (Pawn, (Color) !sideToMove)])
+    {
+      enPassantSquare = (from + to) / 2;
+      key ^= Zobrist::enPassant (enPassantSquare);
+    }
+  }
+
+  if (sideToMove == Black)
+    fullmoveNumber++;
+  sideToMove = (Color) !sideToMove;
+  key ^= Zobrist::side ();
+  checkInvariants ();
+}
+
+/*
+ * take back the last move made with makeMove
+ */
+
+void PieceList::unmakeMove ()
+{
+  hotInsist (!history.empty ());
+  Undo&undo = history.back ();
+  Move move = undo.move;
+  int from = move.getFrom ();
+  int to = move.getTo ();
+
+  sideToMove = (Color) !sideToMove;
+  if (sideToMove == Black)
+    fullmoveNumber--;
+
+  switch (move.getType ())
+  {
+    case Move::Castling:
+      movePiece (to, from);
+      movePiece ((from + to) / 2, to > from ? from + 3 : from - 4);
+      break;
+    case Move::EnPassant:
+      movePiece (to, from);
+      putPiece (sideToMove == White ? to - 8 : to + 8, undo.captured);
+      break;
+    case Move::Promotion:
+      removePiece (to);
+      putPiece (from, makePiece (Pawn, sideToMove));
+      if (undo.captured != None)
+        putPiece (to, undo.captured);
+      break;
+    default:
+      movePiece (to, from);
+      if (undo.captured != None)
+        putPiece (to, undo.captured);
+  }
+
+  castlingRights = undo.castlingRights;
+  enPassantSquare = undo.enPassantSquare;
+  halfmoveClock = undo.halfmoveClock;
+  key = undo.key;
+  history.pop_back ();
+  checkInvariants ();
+}
+
+/*
+ * pass, for null move pruning. the clock is reset so repetitions aren't looked for
+ * across the null move.
+ */
+
+void PieceList::makeNullMove ()
+{
+  history.push_back ({Move (), None, castlingRights, enPassantSquare, halfmoveClock, key});
+
+  if (enPassantSquare != NO_SQUARE)
+    key ^= Zobrist::enPassant (enPassantSquare);
+  enPassantSquare = NO_SQUARE;
+  halfmoveClock = 0;
+  sideToMove = (Color) !sideToMove;
+  key ^= Zobrist::side ();
+  checkInvariants ();
+}
+
+void PieceList::unmakeNullMove ()
+{
+  hotInsist (!history.empty () && history.back ().move.isNull ());
+  Undo&undo = history.back ();
+
+  sideToMove = (Color) !sideToMove;
+  enPassantSquare = undo.enPassantSquare;
+  halfmoveClock = undo.halfmoveClock;
+  key = undo.key;
+  history.pop_back ();
+  checkInvariants ();
+}
+
+/*
+ * true if the current position has happened before. only positions since the last
+ * capture or pawn move can repeat, and only every other one has the same side to move.
+ */
+
+bool PieceList::isRepetition ()
+{
+  int n = (int) history.size ();
+  int back = halfmoveClock < n ? halfmoveClock : n;
+
+  for (int i = 4; i <= back; i += 2)
+    if (history [n - i].key == key)
+      return true;
+  return false;
 }
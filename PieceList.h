@@ -1,6 +1,12 @@
 #ifndef PieceList_h
 #define PieceList_h
+#include <string>
+#include <vector>
 #include "insist.h"
+#include "Bitboard.h"
+#include "Move.h"
+#include "Zobrist.h"
+#include "Psqt.h"
 
 class PieceList
 {
@@ -22,11 +28,116 @@ class PieceList
     None
   };
 
+  /*the colors and piece types line up with the Piece ordering, piece = 2 * type + color*/
+  enum Color
+  {
+    White,
+    Black
+  };
+
+  enum PieceType
+  {
+    Pawn,
+    Knight,
+    Bishop,
+    Rook,
+    Queen,
+    King
+  };
+
+  /*castling rights, or'ed together*/
+  enum Castling
+  {
+    WhiteKingside = 1,
+    WhiteQueenside = 2,
+    BlackKingside = 4,
+    BlackQueenside = 8
+  };
+
+  enum
+  {
+    NO_SQUARE = -1
+  };
+
   private:
-  Piece squares [64]; //LERF mapping, squares [0] = a1, squares [63] = h7
+  Piece squares [64]; //LERF mapping, squares [0] = a1, squares [63] = h8
+  Bitboard pieces [12]; //one set per Piece, same LERF mapping as squares
+  Bitboard occupancy [2]; //all white pieces, all black pieces
+  Bitboard occupied; //everything
+  Color sideToMove;
+  int castlingRights;
+  int enPassantSquare; //square a pawn can capture onto en passant, or NO_SQUARE
+  int halfmoveClock; //plies since the last capture or pawn move
+  int fullmoveNumber;
+  Bitboard key; //Zobrist key of everything above
+  Score psq; //material and piece-square values of all the pieces, see Psqt
+
+  /*what makeMove can't work backwards from the move itself, kept so unmakeMove can put it back*/
+  struct Undo
+  {
+    Move move;
+    Piece captured;
+    int castlingRights;
+    int enPassantSquare;
+    int halfmoveClock;
+    Bitboard key;
+  };
+  std::vector<Undo>history;
+
+  /*enough for any search on top of a long game, so makeMove doesn't allocate*/
+  enum
+  {
+    HISTORY_RESERVE = 1024
+  };
+
+  void clear ();
+  Bitboard computeKey ();
+  void checkInvariants ();
+
+  /*
+   * the unchecked primitives everything else is built on, they keep the mailbox,
+   * the bitboards, the key and psq in step.
+   */
+  void putPiece (int square, Piece piece)
+  {
+    Bitboard b = Bitboards::bit (square);
+    squares [square] = piece;
+    pieces [piece] ^= b;
+    occupancy [getColor (piece)] ^= b;
+    occupied ^= b;
+    key ^= Zobrist::piece (piece, square);
+    psq += Psqt::piece (piece, square);
+  }
+
+  void removePiece (int square)
+  {
+    Piece piece = squares [square];
+    Bitboard b = Bitboards::bit (square);
+    squares [square] = None;
+    pieces [piece] ^= b;
+    occupancy [getColor (piece)] ^= b;
+    occupied ^= b;
+    key ^= Zobrist::piece (piece, square);
+    psq -= Psqt::piece (piece, square);
+  }
+
+  void movePiece (int from, int to)
+  {
+    Piece piece = squares [from];
+    Bitboard b = Bitboards::bit (from) | Bitboards::bit (to);
+    squares [from] = None;
+    squares [to] = piece;
+    pieces [piece] ^= b;
+    occupancy [getColor (piece)] ^= b;
+    occupied ^= b;
+    key ^= Zobrist::piece (piece, from) ^ Zobrist::piece (piece, to);
+    psq += Psqt::piece (piece, to) - Psqt::piece (piece, from);
+  }
 
   public:
   PieceList();
+  PieceList (const PieceList&other);
+  PieceList&operator= (const PieceList&other);
   void setPiece (int rank, int file, Piece piece);
   void setPiece (int boardIndex, Piece piece);
   Piece getPiece (int boardIndex);
@@ -34,6 +145,114 @@ class PieceList
   bool isWhite (Piece piece);
   Piece other (Piece piece);
   void reset ();
+  bool setFen (std::string fen);
+  std::string getFen ();
+  void makeMove (Move move);
+  void unmakeMove ();
+  void makeNullMove ();
+  void unmakeNullMove ();
+  bool isRepetition ();
+
+  /*bitboard access for the engine. none of these check their arguments*/
+  Bitboard getPieces (Piece piece)
+  {
+    return pieces [piece];
+  }
+
+  Bitboard getPieces (PieceType type, Color color)
+  {
+    return pieces [makePiece (type, color)];
+  }
+
+  Bitboard getOccupancy (Color color)
+  {
+    return occupancy [color];
+  }
+
+  Bitboard getOccupied ()
+  {
+    return occupied;
+  }
+
+  int count (Piece piece)
+  {
+    return Bitboards::popCount (pieces [piece]);
+  }
+
+  /*square of color's king, assumes there is exactly one*/
+  int getKingSquare (Color color)
+  {
+    return Bitboards::lsb (pieces [makePiece (King, color)]);
+  }
+
+  Color getSideToMove ()
+  {
+    return sideToMove;
+  }
+
+  int getCastlingRights ()
+  {
+    return castlingRights;
+  }
+
+  int getEnPassantSquare ()
+  {
+    return enPassantSquare;
+  }
+
+  int getHalfmoveClock ()
+  {
+    return halfmoveClock;
+  }
+
+  int getFullmoveNumber ()
+  {
+    return fullmoveNumber;
+  }
+
+  /*true if color has anything besides pawns and the king*/
+  bool hasNonPawnMaterial (Color color)
+  {
+    return occupancy [color] != (pieces [makePiece (Pawn, color)] | pieces [makePiece (King, color)]);
+  }
+
+  Bitboard getKey ()
+  {
+    return key;
+  }
+
+  /*material and piece-square score, from white's point of view*/
+  Score getPsq ()
+  {
+    return psq;
+  }
+
+  /*number of moves made with makeMove that haven't been unmade*/
+  int getPly ()
+  {
+    return (int) history.size ();
+  }
+
+  /*the move made at ply, counting from the position being set up, ply < getPly ()*/
+  Move getMove (int ply)
+  {
+    return history [ply].move;
+  }
+
+  static Piece makePiece (PieceType type, Color color)
+  {
+    return (Piece) (2 * type + color);
+  }
+
+  static PieceType getType (Piece piece)
+  {
+    return (PieceType) (piece / 2);
+  }
+
+  static Color getColor (Piece piece)
+  {
+    return (Color) (piece % 2);
+  }
 };
 
 #endif // PieceList_h
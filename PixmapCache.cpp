@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <QCoreApplication>
+#include "PixmapCache.h"
+#include "insist.h"
+
+PixmapCache*PixmapCache::cache = 0;
+
+PixmapCache::PixmapCache () : boards (0)
+{
+  /*file names are color then piece letter, in PieceList::Piece order*/
+  const char*names [12] = {"wp", "bp", "wn", "bn", "wb", "bb", "wr", "br", "wq", "bq", "wk", "bk"};
+
+  for (int i = 0; i < 12; i++)
+  {
+    originals [0][i] = QPixmap (QString (":/images/pieces/%1.png").arg (names [i]));
+    originals [1][i] = QPixmap (QString (":/images/pieces_shaded/%1.png").arg (names [i]));
+  }
+}
+
+/*
+ * return the cache, making it the first time
+ */
+
+PixmapCache*PixmapCache::instance ()
+{
+  if (!cache)
+  {
+    cache = new PixmapCache ();
+    qAddPostRoutine (release);
+  }
+  return cache;
+}
+
+void PixmapCache::release ()
+{
+  delete cache;
+  cache = 0;
+}
+
+/*
+ * a board was made or has gone away. a board can outlive the cache as the application
+ * shuts down, so going away doesn't bring the cache back.
+ */
+
+void PixmapCache::addBoard ()
+{
+  instance ()->boards++;
+}
+
+void PixmapCache::removeBoard ()
+{
+  if (cache)
+    cache->boards--;
+}
+
+/*
+ * move size to the front of the recently used list, dropping the pixmaps for the oldest
+ * sizes if there are more than the boards need
+ */
+
+void PixmapCache::touchSize (int size)
+{
+  for (size_t i = 0; i < sizes.size (); i++)
+  {
+    if (sizes [i] == size)
+    {
+      sizes.erase (sizes.begin () + i);
+      break;
+    }
+  }
+  sizes.insert (sizes.begin (), size);
+
+  size_t keep = (size_t) std::max (boards, 1) + SPARE_SIZES;
+  while (sizes.size () > keep)
+  {
+    int old = sizes.back ();
+    sizes.pop_back ();
+    for (int shaded = 0; shaded < 2; shaded++)
+      for (int piece = 0; piece < 12; piece++)
+        scaled.erase ((old << 5) | (shaded << 4) | piece);
+  }
+}
+
+/*
+ * the pixmap for piece, with or without its shadow, scaled to size pixels wide
+ */
+
+QPixmap PixmapCache::getPixmap (PieceList::Piece piece, bool shaded, int size)
+{
+  insist (piece >= PieceList::wPawn && piece < PieceList::None);
+  insist (size > 0);
+
+  if (sizes.empty () || sizes [0] != size)
+    touchSize (size);
+
+  int key = (size << 5) | ((int) shaded << 4) | piece;
+  auto i = scaled.find (key);
+  if (i != scaled.end ())
+    return i->second;
+
+  QPixmap p = originals [shaded][piece].scaledToWidth (size, Qt::SmoothTransformation);
+  scaled [key] = p;
+  return p;
+}
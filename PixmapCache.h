@@ -0,0 +1,47 @@
+#ifndef PixmapCache_h
+#define PixmapCache_h
+
+#include <unordered_map>
+#include <vector>
+#include <QPixmap>
+#include "PieceList.h"
+
+/*
+ * one process-wide cache of piece pixmaps, shared by every board. each image is decoded once,
+ * and each (piece, shaded, size) is smooth-scaled once and then handed out to every piece
+ * that needs it. QPixmaps are implicitly shared so handing them out costs nothing.
+ *
+ * only the last few sizes asked for are kept, a window being resized goes through lots of
+ * sizes that won't be seen again. boards come in different sizes, so every board says when
+ * it comes and goes and the cache keeps a size for each of them plus a few spare, or with a
+ * dozen boards open every repaint would be scaling pixmaps again.
+ *
+ * QPixmaps can only be made once there's a QApplication and only used on the GUI thread,
+ * so the cache is made on first use and freed when the application goes away.
+ */
+
+class PixmapCache
+{
+  public:
+  static PixmapCache*instance ();
+  QPixmap getPixmap (PieceList::Piece piece, bool shaded, int size);
+  static void addBoard ();
+  static void removeBoard ();
+
+  private:
+  enum
+  {
+    SPARE_SIZES = 3 //on top of one per board, for the sizes a resize goes through
+  };
+  QPixmap originals [2][12]; //[shaded][piece]
+  std::unordered_map<int, QPixmap>scaled;
+  std::vector<int>sizes; //sizes in the cache, most recently used first
+  int boards; //boards showing pieces
+
+  PixmapCache ();
+  void touchSize (int size);
+  static void release ();
+  static PixmapCache*cache;
+};
+
+#endif // PixmapCache_h
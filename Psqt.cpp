@@ -0,0 +1,185 @@
+#include <mutex>
+#include "Psqt.h"
+
+Score Psqt::scores [12][64];
+
+/*
+ * the tables from white's point of view, laid out as a board is read, rank 8 first, so
+ * square s of white's uses entry s ^ 56 and black's entry s. the middlegame ones say where
+ * pieces develop to, the endgame ones mostly that pawns should run and kings come out.
+ */
+
+static int pawnMg [64] =
+{
+   0,  0,  0,  0,  0,  0,  0,  0,
+  50, 50, 50, 50, 50, 50, 50, 50,
+  10, 10, 20, 30, 30, 20, 10, 10,
+   5,  5, 10, 25, 25, 10,  5,  5,
+   0,  0,  0, 20, 20,  0,  0,  0,
+   5, -5,-10,  0,  0,-10, -5,  5,
+   5, 10, 10,-20,-20, 10, 10,  5,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static int knightMg [64] =
+{
+  -50,-40,-30,-30,-30,-30,-40,-50,
+  -40,-20,  0,  0,  0,  0,-20,-40,
+  -30,  0, 10, 15, 15, 10,  0,-30,
+  -30,  5, 15, 20, 20, 15,  5,-30,
+  -30,  0, 15, 20, 20, 15,  0,-30,
+  -30,  5, 10, 15, 15, 10,  5,-30,
+  -40,-20,  0,  5,  5,  0,-20,-40,
+  -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+static int bishopMg [64] =
+{
+  -20,-10,-10,-10,-10,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5, 10, 10,  5,  0,-10,
+  -10,  5,  5, 10, 10,  5,  5,-10,
+  -10,  0, 10, 10, 10, 10,  0,-10,
+  -10, 10, 10, 10, 10, 10, 10,-10,
+  -10,  5,  0,  0,  0,  0,  5,-10,
+  -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+static int rookMg [64] =
+{
+   0,  0,  0,  0,  0,  0,  0,  0,
+   5, 10, 10, 10, 10, 10, 10,  5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+  -5,  0,  0,  0,  0,  0,  0, -5,
+   0,  0,  0,  5,  5,  0,  0,  0
+};
+
+static int queenMg [64] =
+{
+  -20,-10,-10, -5, -5,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5,  5,  5,  5,  0,-10,
+   -5,  0,  5,  5,  5,  5,  0, -5,
+    0,  0,  5,  5,  5,  5,  0, -5,
+  -10,  5,  5,  5,  5,  5,  0,-10,
+  -10,  0,  5,  0,  0,  0,  0,-10,
+  -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+static int kingMg [64] =
+{
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -30,-40,-40,-50,-50,-40,-40,-30,
+  -20,-30,-30,-40,-40,-30,-30,-20,
+  -10,-20,-20,-20,-20,-20,-20,-10,
+   20, 20,  0,  0,  0,  0, 20, 20,
+   20, 30, 10,  0,  0, 10, 30, 20
+};
+
+static int pawnEg [64] =
+{
+   0,  0,  0,  0,  0,  0,  0,  0,
+  80, 80, 80, 80, 80, 80, 80, 80,
+  50, 50, 50, 50, 50, 50, 50, 50,
+  30, 30, 30, 30, 30, 30, 30, 30,
+  15, 15, 15, 15, 15, 15, 15, 15,
+   5,  5,  5,  5,  5,  5,  5,  5,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static int knightEg [64] =
+{
+  -50,-40,-30,-30,-30,-30,-40,-50,
+  -40,-20,  0,  0,  0,  0,-20,-40,
+  -30,  0, 10, 15, 15, 10,  0,-30,
+  -30,  0, 15, 20, 20, 15,  0,-30,
+  -30,  0, 15, 20, 20, 15,  0,-30,
+  -30,  0, 10, 15, 15, 10,  0,-30,
+  -40,-20,  0,  0,  0,  0,-20,-40,
+  -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+static int bishopEg [64] =
+{
+  -20,-10,-10,-10,-10,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5, 10, 10,  5,  0,-10,
+  -10,  0, 10, 15, 15, 10,  0,-10,
+  -10,  0, 10, 15, 15, 10,  0,-10,
+  -10,  0,  5, 10, 10,  5,  0,-10,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+static int rookEg [64] =
+{
+   5,  5,  5,  5,  5,  5,  5,  5,
+  10, 10, 10, 10, 10, 10, 10, 10,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static int queenEg [64] =
+{
+  -20,-10,-10, -5, -5,-10,-10,-20,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -10,  0,  5,  5,  5,  5,  0,-10,
+   -5,  0,  5, 10, 10,  5,  0, -5,
+   -5,  0,  5, 10, 10,  5,  0, -5,
+  -10,  0,  5,  5,  5,  5,  0,-10,
+  -10,  0,  0,  0,  0,  0,  0,-10,
+  -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+static int kingEg [64] =
+{
+  -50,-40,-30,-20,-20,-30,-40,-50,
+  -30,-20,-10,  0,  0,-10,-20,-30,
+  -30,-10, 20, 30, 30, 20,-10,-30,
+  -30,-10, 30, 40, 40, 30,-10,-30,
+  -30,-10, 30, 40, 40, 30,-10,-30,
+  -30,-10, 20, 30, 30, 20,-10,-30,
+  -30,-30,  0,  0,  0,  0,-30,-30,
+  -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+static int*mgTables [6] = {pawnMg, knightMg, bishopMg, rookMg, queenMg, kingMg};
+static int*egTables [6] = {pawnEg, knightEg, bishopEg, rookEg, queenEg, kingEg};
+
+/*material, the endgame values favour rooks and pawns a little over the minor pieces*/
+static int mgValues [6] = {100, 320, 330, 500, 900, 0};
+static int egValues [6] = {120, 290, 310, 540, 950, 0};
+
+/*
+ * fold the material into the tables and pack them. safe to call more than once.
+ */
+
+void Psqt::init ()
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    for (int piece = 0; piece < 12; piece++)
+    {
+      int type = piece / 2;
+      bool white = piece % 2 == 0;
+      for (int square = 0; square < 64; square++)
+      {
+        int entry = white ? square ^ 56 : square;
+        int mg = mgValues [type] + mgTables [type][entry];
+        int eg = egValues [type] + egTables [type][entry];
+        scores [piece][square] = white ? makeScore (mg, eg) : makeScore (-mg, -eg);
+      }
+    }
+  });
+}
@@ -0,0 +1,50 @@
+#ifndef Psqt_h
+#define Psqt_h
+
+/*
+ * piece-square tables for the evaluation, with the piece's material value folded in, so
+ * one lookup is all a piece on a square is worth. there's a middlegame and an endgame value
+ * for each, blended by how much material is left (see Evaluator).
+ *
+ * the two values are packed into one int, a Score, endgame in the high 16 bits and
+ * middlegame in the low 16, so adding and subtracting Scores does both at once. the low half
+ * is signed, and borrows from the high half when it's negative, which getEg undoes by
+ * rounding. this holds as long as both halves stay inside a short, which anything a position
+ * adds up to does.
+ *
+ * scores are from white's point of view, so black pieces have negative entries. PieceList
+ * keeps the sum over all its pieces up to date in putPiece/removePiece/movePiece.
+ */
+
+typedef int Score;
+
+class Psqt
+{
+  public:
+  static void init ();
+
+  static Score makeScore (int mg, int eg)
+  {
+    return (Score) ((unsigned) eg << 16) + mg;
+  }
+
+  static int getMg (Score score)
+  {
+    return (short) (unsigned) score;
+  }
+
+  static int getEg (Score score)
+  {
+    return (short) ((unsigned) (score + 0x8000) >> 16);
+  }
+
+  static Score piece (int piece, int square)
+  {
+    return scores [piece][square];
+  }
+
+  private:
+  static Score scores [12][64];
+};
+
+#endif // Psqt_h
@@ -0,0 +1,803 @@
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include "Search.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "Tablebases.h"
+#include "insist.h"
+
+int Search::reductions [64][64];
+
+Search::Search (TranspositionTable*tt, int id) : tt (tt), id (id), helpers (0), stopped (false), pondering (false), clockRunning (true), clockStart (0), publishedNodes (0), limitReached (false), optimumTime (0), maximumTime (0), nodes (0), tracing (false), selectiveDepth (0), score (0), rootInTables (false)
+{
+  initReductions ();
+}
+
+/*late move reductions grow with both the depth and how late the move is*/
+void Search::initReductions ()
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    for (int d = 1; d < 64; d++)
+      for (int m = 1; m < 64; m++)
+        reductions [d][m] = (int) (0.75 + std::log (d) * std::log (m) / 2.25);
+  });
+}
+
+void Search::stop ()
+{
+  stopped = true;
+  pondering = false;
+}
+
+/*
+ * nodes searched so far, including helpers'. safe to call from other threads, though then
+ * it can be a little behind.
+ */
+
+long long Search::getNodes ()
+{
+  long long total = publishedNodes;
+  if (helpers)
+    for (Search*h : *helpers)
+      total += h->publishedNodes;
+  return total;
+}
+
+/*
+ * the counts of this search and its helpers. only right once they've all stopped, the helpers'
+ * counters aren't safe to read while they're running.
+ */
+
+Search::Stats Search::getStats ()
+{
+  stats.nodes = nodes;
+  Stats total = stats;
+  if (helpers)
+    for (Search*h : *helpers)
+    {
+      h->stats.nodes = h->nodes;
+      total.add (h->stats);
+    }
+  return total;
+}
+
+/*the counters, for the code that does the same to all of them*/
+static long long Search::Stats::*counters [] =
+{
+  &Search::Stats::nodes, &Search::Stats::qnodes, &Search::Stats::ttProbes, &Search::Stats::ttHits,
+  &Search::Stats::ttCutoffs, &Search::Stats::cutoffs, &Search::Stats::firstMoveCutoffs,
+  &Search::Stats::nullMoves, &Search::Stats::nullMoveCutoffs, &Search::Stats::reductions,
+  &Search::Stats::reSearches, &Search::Stats::evals
+};
+
+static const char*counterNames [] =
+{
+  "nodes", "qnodes", "ttProbes", "ttHits", "ttCutoffs", "cutoffs", "firstMoveCutoffs",
+  "nullMoves", "nullMoveCutoffs", "reductions", "reSearches", "evals"
+};
+
+void Search::Stats::add (const Stats&other)
+{
+  for (auto counter : counters)
+    this->*counter += other.*counter;
+}
+
+void Search::Stats::subtract (const Stats&other)
+{
+  for (auto counter : counters)
+    this->*counter -= other.*counter;
+}
+
+static double percent (long long part, long long whole)
+{
+  return whole > 0 ? 100.0 * part / whole : 0;
+}
+
+/*
+ * one line, the counts and the rates that say something: how often the hash table helps, how
+ * good the move ordering is (a cutoff should nearly always come from the first move), and
+ * how often null move and late move reductions pay off rather than costing a search.
+ */
+
+std::string Search::Stats::toString ()
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision (1)
+      << "nodes " << nodes << " qnodes " << qnodes << " (" << percent (qnodes, nodes) << "%)"
+      << " tthits " << percent (ttHits, ttProbes) << "% ttcuts " << percent (ttCutoffs, ttProbes) << "%"
+      << " firstcut " << percent (firstMoveCutoffs, cutoffs) << "%"
+      << " nullcut " << percent (nullMoveCutoffs, nullMoves) << "% of " << nullMoves
+      << " lmr ok " << percent (reductions - reSearches, reductions) << "% of " << reductions
+      << " evals " << evals;
+  return out.str ();
+}
+
+long long Search::now ()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+/*
+ * the iterations main and its helpers kept in their last search, with tracing on, as Chrome
+ * trace JSON: an event per iteration with its counts, on a row per thread. only once the
+ * search is over, like getStats.
+ */
+
+void Search::writeTrace (std::ostream&out, Search*main)
+{
+  std::vector<Search*>searches (1, main);
+  if (main->helpers)
+    searches.insert (searches.end (), main->helpers->begin (), main->helpers->end ());
+  long long base = std::chrono::duration_cast<std::chrono::microseconds> (main->start.time_since_epoch ()).count ();
+
+  out << "{\"traceEvents\":[\n";
+  bool first = true;
+  for (Search*search : searches)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << search->id
+        << ",\"args\":{\"name\":\"" << (search->id == 0 ? "main" : "helper " + std::to_string (search->id)) << "\"}}";
+    first = false;
+
+    for (Iteration&i : search->iterations)
+    {
+      out << ",\n{\"name\":\"depth " << i.depth << "\",\"cat\":\"search\",\"ph\":\"X\",\"pid\":1,\"tid\":" << search->id
+          << ",\"ts\":" << i.start - base << ",\"dur\":" << i.duration << ",\"args\":{\"score\":" << i.score;
+      for (size_t c = 0; c < sizeof (counters) / sizeof (counters [0]); c++)
+        out << ",\"" << counterNames [c] << "\":" << i.stats.*counters [c];
+      out << "}}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+/*
+ * mate scores are stored relative to the node they're found in rather than the root, so
+ * they stay right when the same position turns up at another ply
+ */
+
+int Search::scoreToTable (int score, int ply)
+{
+  return score >= MATE_IN_MAX_PLY ? score + ply : score <= -MATE_IN_MAX_PLY ? score - ply : score;
+}
+
+int Search::scoreFromTable (int score, int ply)
+{
+  return score >= MATE_IN_MAX_PLY ? score - ply : score <= -MATE_IN_MAX_PLY ? score + ply : score;
+}
+
+int Search::elapsed ()
+{
+  return (int) std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/*
+ * milliseconds on the clock for this search. time spent pondering before the ponderhit is the
+ * opponent's, so it doesn't count.
+ */
+
+int Search::clockTime ()
+{
+  if (!clockRunning)
+  {
+    if (pondering)
+      return 0;
+    clockRunning = true;
+    clockStart = elapsed ();
+  }
+  return elapsed () - clockStart;
+}
+
+/*
+ * work out how long to think. a fixed move time is used as is. with a clock, aim for an even
+ * share of the remaining time plus most of the increment, and never go past a quarter of
+ * what's left. a little is held back for getting the move out.
+ */
+
+void Search::allocateTime ()
+{
+  optimumTime = maximumTime = 0;
+
+  if (limits.infinite)
+    return;
+  if (limits.moveTime > 0)
+    optimumTime = maximumTime = limits.moveTime;
+  else if (limits.timeLeft > 0)
+  {
+    int movesToGo = limits.movesToGo > 0 ? limits.movesToGo : 30;
+    int overhead = 20;
+    int left = limits.timeLeft - overhead > 1 ? limits.timeLeft - overhead : 1;
+
+    optimumTime = left / movesToGo + limits.increment * 3 / 4;
+    maximumTime = optimumTime * 3;
+    if (maximumTime > left / 4 + limits.increment)
+      maximumTime = left / 4 + limits.increment;
+    if (maximumTime > left)
+      maximumTime = left;
+    if (optimumTime > maximumTime)
+      optimumTime = maximumTime;
+  }
+}
+
+/*
+ * called every CHECK_INTERVAL nodes, sets limitReached if the node or hard time limit has been
+ * hit. neither applies under go infinite or before a ponderhit.
+ */
+
+void Search::checkLimits ()
+{
+  publishedNodes.store (nodes, std::memory_order_relaxed);
+  if (id != 0)
+    return;
+
+  if (limits.infinite || pondering)
+    return;
+  if (limits.nodes > 0 && getNodes () >= limits.nodes)
+    limitReached = true;
+  if (maximumTime > 0 && clockTime () >= maximumTime)
+    limitReached = true;
+}
+
+/*
+ * helpers skip some iterations, in a pattern that depends on their id, so that at any moment
+ * the threads are spread over a few different depths instead of all doing the same work.
+ */
+
+bool Search::skipDepth (int depth)
+{
+  static int skipSize [20] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+  static int skipPhase [20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+  if (id == 0)
+    return false;
+  int i = (id - 1) % 20;
+  return ((depth + skipPhase [i]) / skipSize [i]) % 2 != 0;
+}
+
+/*
+ * fifty move rule, repetition or nothing left to mate with
+ */
+
+bool Search::isDraw ()
+{
+  if (position.getHalfmoveClock () >= 100 || position.isRepetition ())
+    return true;
+
+  /*bare kings, or a single minor piece against a bare king*/
+  Bitboard occupied = position.getOccupied ();
+  if (Bitboards::popCount (occupied) <= 3)
+  {
+    Bitboard minors = position.getPieces (PieceList::wKnight) | position.getPieces (PieceList::bKnight) |
+                      position.getPieces (PieceList::wBishop) | position.getPieces (PieceList::bBishop);
+    return Bitboards::popCount (occupied) == 2 || minors;
+  }
+  return false;
+}
+
+/*
+ * a tablebase result for the position, if it has one. only just after a capture or pawn move,
+ * where the fifty move counter is 0 so a win is a win, and not when the root was already in
+ * the tables: then the root moves keep the result and the search just has to pick between
+ * them. wins and losses are scored just short of a mate, and are only bounds, a real mate
+ * found by searching counts for more.
+ */
+
+bool Search::probeTablebases (int ply, int&value, TranspositionTable::Bound&bound)
+{
+  if (rootInTables || position.getHalfmoveClock () != 0 || position.getCastlingRights () ||
+      Bitboards::popCount (position.getOccupied ()) > Tablebases::getMaxPieces ())
+    return false;
+
+  int wdl;
+  if (!Tablebases::probeWdl (position, wdl))
+    return false;
+
+  if (wdl > Tablebases::CursedWin)
+  {
+    value = MATE_IN_MAX_PLY - ply - 1;
+    bound = TranspositionTable::Lower;
+  }
+  else if (wdl < Tablebases::BlessedLoss)
+  {
+    value = -MATE_IN_MAX_PLY + ply + 1;
+    bound = TranspositionTable::Upper;
+  }
+  else
+  {
+    value = 2 * wdl; //the fifty move rule saves it, just about
+    bound = TranspositionTable::Exact;
+  }
+  return true;
+}
+
+/*
+ * search to limits and return the best move, or a null move if there are no legal moves.
+ * callback, if there is one, gets the principal variation after every completed iteration.
+ */
+
+Move Search::think (PieceList&p, Limits limits, InfoCallback callback)
+{
+  start = std::chrono::steady_clock::now ();
+  position = p;
+  this->limits = limits;
+  score = 0;
+  limitReached = false;
+
+  /*a helper's counts are cleared with clearStats, and run on if it's stopped and picks up again*/
+  if (id == 0)
+  {
+    nodes = 0;
+    publishedNodes = 0;
+    stats = Stats ();
+    iterations.clear ();
+    clockRunning = !pondering;
+    clockStart = 0;
+    allocateTime ();
+    tt->newSearch ();
+  }
+
+  memset (killers, 0, sizeof (killers));
+  memset (history, 0, sizeof (history));
+
+  rootMoves.clear ();
+  MoveGenerator::generate (position, rootMoves);
+  if (rootMoves.getSize () == 0)
+    return Move ();
+  rootInTables = Tablebases::rootProbe (position, rootMoves);
+
+  Move bestMove = rootMoves [0];
+  rootBestMove = Move ();
+  int maxDepth = limits.depth > 0 && limits.depth < MAX_PLY ? limits.depth : MAX_PLY - 1;
+  pvLength [0] = 0;
+
+  for (int depth = 1; depth <= maxDepth; depth++)
+  {
+    if (depth > 1 && skipDepth (depth))
+      continue;
+    selectiveDepth = 0;
+    long long iterationStart = tracing ? now () : 0;
+    stats.nodes = nodes;
+    Stats before = stats;
+
+    /*aspiration window, widened on the side that failed until the score fits*/
+    int delta = 25;
+    int alpha = -INFINITE, beta = INFINITE;
+    if (depth >= 5)
+    {
+      alpha = score - delta > -INFINITE ? score - delta : -INFINITE;
+      beta = score + delta < INFINITE ? score + delta : INFINITE;
+    }
+
+    int value;
+    while (true)
+    {
+      value = search (alpha, beta, depth, 0, false);
+      if (isStopped ())
+        break;
+
+      if (value <= alpha)
+      {
+        beta = (alpha + beta) / 2;
+        alpha = value - delta > -INFINITE ? value - delta : -INFINITE;
+      }
+      else if (value >= beta)
+        beta = value + delta < INFINITE ? value + delta : INFINITE;
+      else
+        break;
+      delta += delta;
+    }
+
+    /*an interrupted iteration can't be trusted, unless it's the first and there's nothing better*/
+    if (isStopped () && depth > 1)
+      break;
+
+    score = value;
+    if (pvLength [0] > 0)
+      bestMove = rootBestMove = pv [0][0];
+
+    stats.nodes = nodes;
+    if (tracing)
+    {
+      Iteration iteration = {depth, score, iterationStart, now () - iterationStart, stats};
+      iteration.stats.subtract (before);
+      iterations.push_back (iteration);
+    }
+
+    if (callback && id == 0)
+    {
+      /*so the count isn't up to CHECK_INTERVAL behind*/
+      publishedNodes.store (nodes, std::memory_order_relaxed);
+
+      Info info;
+      info.depth = depth;
+      info.selectiveDepth = selectiveDepth;
+      info.score = score;
+      info.nodes = getNodes ();
+      info.time = elapsed ();
+      info.hashfull = tt->hashfull ();
+      info.pv.assign (pv [0], pv [0] + pvLength [0]);
+      info.stats = stats;
+      callback (info);
+    }
+
+    /*found a mate, or unlikely to finish another iteration in time*/
+    if (isStopped ())
+      break;
+    if (id != 0)
+      continue;
+    if (std::abs (score) >= MATE_IN_MAX_PLY)
+      break;
+    if (optimumTime > 0 && clockTime () > optimumTime / 2)
+      break;
+  }
+
+  /*the move can't be given while pondering or under go infinite, wait to be told*/
+  if (id == 0)
+    while (!stopped && (pondering || limits.infinite))
+      std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+  publishedNodes = nodes;
+  stats.nodes = nodes;
+  return bestMove;
+}
+
+/*
+ * give each move a score to be tried in. best (the hash or pv move) goes first, then captures
+ * most valuable victim first, then killers, then history.
+ */
+
+void Search::scoreMoves (MoveList&moves, int*scores, Move best, int ply)
+{
+  for (int i = 0; i < moves.getSize (); i++)
+  {
+    Move m = moves [i];
+    PieceList::Piece moving = position.getPiece (m.getFrom ());
+    PieceList::Piece victim = position.getPiece (m.getTo ());
+
+    if (m == best)
+      scores [i] = 1 << 30;
+    else if (victim != PieceList::None || m.getType () == Move::EnPassant || m.getType () == Move::Promotion)
+    {
+      int value = victim != PieceList::None ? Evaluator::pieceValue (PieceList::getType (victim)) : 100;
+      if (m.getType () == Move::Promotion)
+        value += Evaluator::pieceValue (m.getPromotion ()) - (m.getPromotion () == PieceList::Queen ? 0 : 2000);
+      scores [i] = (1 << 24) + value * 16 - PieceList::getType (moving);
+    }
+    else if (m == killers [ply][0])
+      scores [i] = (1 << 23);
+    else if (m == killers [ply][1])
+      scores [i] = (1 << 23) - 1;
+    else
+      scores [i] = history [moving][m.getTo ()];
+  }
+}
+
+/*
+ * selection sort one step at a time, most nodes cut off after the first few moves
+ */
+
+Move Search::pickMove (MoveList&moves, int*scores, int i)
+{
+  int best = i;
+  for (int j = i + 1; j < moves.getSize (); j++)
+    if (scores [j] > scores [best])
+      best = j;
+
+  std::swap (moves [i], moves [best]);
+  std::swap (scores [i], scores [best]);
+  return moves [i];
+}
+
+/*
+ * a quiet move caused a cutoff: make it a killer, reward it and punish the quiets tried before it
+ */
+
+void Search::updateQuietStats (Move move, Move*quiets, int quietCount, int depth, int ply)
+{
+  if (killers [ply][0] != move)
+  {
+    killers [ply][1] = killers [ply][0];
+    killers [ply][0] = move;
+  }
+
+  int bonus = depth * depth < 1200 ? depth * depth : 1200;
+  for (int i = 0; i < quietCount; i++)
+  {
+    Move m = quiets [i];
+    int&h = history [position.getPiece (m.getFrom ())][m.getTo ()];
+    int b = m == move ? bonus : -bonus;
+
+    /*gravity keeps the scores bounded*/
+    h += b - h * std::abs (b) / 16384;
+  }
+}
+
+int Search::search (int alpha, int beta, int depth, int ply, bool nullAllowed)
+{
+  bool pvNode = beta - alpha > 1;
+  bool root = ply == 0;
+  pvLength [ply] = ply;
+
+  if (depth <= 0)
+    return quiesce (alpha, beta, ply);
+
+  if (++nodes % CHECK_INTERVAL == 0)
+    checkLimits ();
+  if (isStopped ())
+    return 0;
+
+  if (!root)
+  {
+    if (isDraw ())
+      return 0;
+    if (ply >= MAX_PLY)
+      return evaluate ();
+
+    /*mate distance pruning, no point looking for a longer mate than one already found*/
+    alpha = alpha > -MATE + ply ? alpha : -MATE + ply;
+    beta = beta < MATE - ply - 1 ? beta : MATE - ply - 1;
+    if (alpha >= beta)
+      return alpha;
+  }
+
+  /*a deep enough result for this position, outside the pv, settles it*/
+  TranspositionTable::Entry entry;
+  bool hit = tt->probe (position.getKey (), entry);
+  stats.ttProbes++;
+  stats.ttHits += hit;
+  int ttScore = hit ? scoreFromTable (entry.score, ply) : 0;
+  if (hit && !pvNode && entry.depth >= depth &&
+      (entry.bound == TranspositionTable::Exact ||
+       (entry.bound == TranspositionTable::Lower && ttScore >= beta) ||
+       (entry.bound == TranspositionTable::Upper && ttScore <= alpha)))
+  {
+    stats.ttCutoffs++;
+    return ttScore;
+  }
+
+  bool inCheck = MoveGenerator::inCheck (position);
+  PieceList::Color us = position.getSideToMove ();
+  int eval = hit ? entry.eval : inCheck ? 0 : evaluate ();
+
+  /*
+   * null move: if passing still leaves us above beta, a real move almost certainly would too.
+   * not in check, not in pv nodes and not with only pawns left, where zugzwang is common.
+   */
+  if (!pvNode && !inCheck && nullAllowed && depth >= 3 && position.hasNonPawnMaterial (us) && eval >= beta)
+  {
+    int r = 3 + depth / 4;
+    stats.nullMoves++;
+    position.makeNullMove ();
+    int value = -search (-beta, -beta + 1, depth - r, ply + 1, false);
+    position.unmakeNullMove ();
+
+    if (isStopped ())
+      return 0;
+    if (value >= beta)
+    {
+      stats.nullMoveCutoffs++;
+      return value >= MATE_IN_MAX_PLY ? beta : value;
+    }
+  }
+
+  /*
+   * a tablebase result settles the node if it's exact or outside the window. otherwise, in the
+   * pv, a win is as good as the search can do and a loss as bad
+   */
+  int bestValue = -INFINITE;
+  int maxValue = INFINITE;
+  int originalAlpha = alpha;
+  int tbValue;
+  TranspositionTable::Bound tbBound;
+  if (!root && probeTablebases (ply, tbValue, tbBound))
+  {
+    if (tbBound == TranspositionTable::Exact || (tbBound == TranspositionTable::Lower ? tbValue >= beta : tbValue <= alpha))
+    {
+      int tbDepth = depth + 6 < MAX_PLY ? depth + 6 : MAX_PLY - 1;
+      tt->store (position.getKey (), Move (), tbValue, eval, tbDepth, tbBound);
+      return tbValue;
+    }
+    if (pvNode)
+    {
+      if (tbBound == TranspositionTable::Lower)
+      {
+        bestValue = tbValue;
+        alpha = alpha > tbValue ? alpha : tbValue;
+      }
+      else
+        maxValue = tbValue;
+    }
+  }
+
+  MoveList moves;
+  if (root)
+    moves = rootMoves;
+  else
+    MoveGenerator::generate (position, moves);
+  if (moves.getSize () == 0)
+    return inCheck ? -MATE + ply : 0;
+
+  int scores [MoveList::MAX_MOVES];
+  scoreMoves (moves, scores, root ? rootBestMove : hit ? entry.move : Move (), ply);
+
+  Move quiets [MoveList::MAX_MOVES];
+  int quietCount = 0;
+  Move bestMove;
+
+  for (int i = 0; i < moves.getSize (); i++)
+  {
+    Move move = pickMove (moves, scores, i);
+    bool quiet = position.getPiece (move.getTo ()) == PieceList::None &&
+                 move.getType () != Move::EnPassant && move.getType () != Move::Promotion;
+
+    position.makeMove (move);
+    bool givesCheck = MoveGenerator::inCheck (position);
+    int newDepth = depth - 1 + (givesCheck ? 1 : 0); //check extension
+    int value;
+
+    if (i == 0)
+      value = -search (-beta, -alpha, newDepth, ply + 1, true);
+    else
+    {
+      /*late quiet moves are searched shallower first, and again at full depth if they look good*/
+      int r = 0;
+      if (depth >= 3 && quiet && !inCheck && !givesCheck && i >= 3)
+      {
+        r = reductions [depth < 64 ? depth : 63][i < 64 ? i : 63];
+        if (pvNode)
+          r--;
+        if (move == killers [ply][0] || move == killers [ply][1])
+          r--;
+        r = r < 0 ? 0 : r > newDepth - 1 ? newDepth - 1 : r;
+      }
+
+      stats.reductions += r > 0;
+      value = -search (-alpha - 1, -alpha, newDepth - r, ply + 1, true);
+      if (value > alpha && r > 0)
+      {
+        stats.reSearches++;
+        value = -search (-alpha - 1, -alpha, newDepth, ply + 1, true);
+      }
+      if (value > alpha && value < beta)
+        value = -search (-beta, -alpha, newDepth, ply + 1, true);
+    }
+    position.unmakeMove ();
+
+    if (isStopped ())
+      return 0;
+
+    if (quiet)
+      quiets [quietCount++] = move;
+
+    if (value > bestValue)
+    {
+      bestValue = value;
+      if (value > alpha)
+      {
+        alpha = value;
+        bestMove = move;
+
+        /*new principal variation: this move followed by the child's*/
+        pv [ply][ply] = move;
+        for (int j = ply + 1; j < pvLength [ply + 1]; j++)
+          pv [ply][j] = pv [ply + 1][j];
+        pvLength [ply] = pvLength [ply + 1] > ply + 1 ? pvLength [ply + 1] : ply + 1;
+
+        if (value >= beta)
+        {
+          stats.cutoffs++;
+          stats.firstMoveCutoffs += i == 0;
+          if (quiet)
+            updateQuietStats (move, quiets, quietCount, depth, ply);
+          break;
+        }
+      }
+    }
+  }
+
+  if (bestValue > maxValue)
+    bestValue = maxValue;
+
+  TranspositionTable::Bound bound = bestValue >= beta ? TranspositionTable::Lower :
+                                    bestValue > originalAlpha ? TranspositionTable::Exact : TranspositionTable::Upper;
+  tt->store (position.getKey (), bestMove, scoreToTable (bestValue, ply), eval, depth, bound);
+  return bestValue;
+}
+
+/*
+ * captures only, until the position is quiet, so that the static eval isn't taken in the
+ * middle of an exchange. in check every evasion is searched since standing pat isn't an option.
+ */
+
+int Search::quiesce (int alpha, int beta, int ply)
+{
+  pvLength [ply] = ply;
+
+  stats.qnodes++;
+  if (++nodes % CHECK_INTERVAL == 0)
+    checkLimits ();
+  if (isStopped ())
+    return 0;
+
+  if (ply > selectiveDepth)
+    selectiveDepth = ply;
+
+  if (isDraw ())
+    return 0;
+
+  bool inCheck = MoveGenerator::inCheck (position);
+  if (ply >= MAX_PLY)
+    return inCheck ? 0 : evaluate ();
+
+  TranspositionTable::Entry entry;
+  bool hit = tt->probe (position.getKey (), entry);
+  stats.ttProbes++;
+  stats.ttHits += hit;
+  if (hit && beta - alpha == 1)
+  {
+    int ttScore = scoreFromTable (entry.score, ply);
+    if (entry.bound == TranspositionTable::Exact ||
+        (entry.bound == TranspositionTable::Lower && ttScore >= beta) ||
+        (entry.bound == TranspositionTable::Upper && ttScore <= alpha))
+    {
+      stats.ttCutoffs++;
+      return ttScore;
+    }
+  }
+
+  int bestValue = -INFINITE;
+  int eval = hit ? entry.eval : inCheck ? 0 : evaluate ();
+  int originalAlpha = alpha;
+  Move bestMove;
+
+  if (!inCheck)
+  {
+    bestValue = eval;
+    if (bestValue >= beta)
+      return bestValue;
+    if (bestValue > alpha)
+      alpha = bestValue;
+  }
+
+  MoveList moves;
+  MoveGenerator::generate (position, moves, inCheck ? MoveGenerator::All : MoveGenerator::Captures);
+  if (inCheck && moves.getSize () == 0)
+    return -MATE + ply;
+
+  int scores [MoveList::MAX_MOVES];
+  scoreMoves (moves, scores, hit ? entry.move : Move (), ply);
+
+  for (int i = 0; i < moves.getSize (); i++)
+  {
+    Move move = pickMove (moves, scores, i);
+
+    position.makeMove (move);
+    int value = -quiesce (-beta, -alpha, ply + 1);
+    position.unmakeMove ();
+
+    if (isStopped ())
+      return 0;
+
+    if (value > bestValue)
+    {
+      bestValue = value;
+      if (value > alpha)
+      {
+        alpha = value;
+        bestMove = move;
+        if (value >= beta)
+          break;
+      }
+    }
+  }
+
+  TranspositionTable::Bound bound = bestValue >= beta ? TranspositionTable::Lower :
+                                    bestValue > originalAlpha ? TranspositionTable::Exact : TranspositionTable::Upper;
+  tt->store (position.getKey (), bestMove, scoreToTable (bestValue, ply), eval, 0, bound);
+  return bestValue;
+}
@@ -0,0 +1,235 @@
+#ifndef Search_h
+#define Search_h
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "PieceList.h"
+#include "MoveList.h"
+#include "TranspositionTable.h"
+#include "Evaluator.h"
+
+/*
+ * principal variation alpha-beta search.
+ *
+ * think () runs iterative deepening on a copy of the position, each iteration inside an
+ * aspiration window around the last score. the tree search is negamax with a null window
+ * for every move after the first, null move pruning and late move reductions, and drops
+ * into a captures-only quiescence search at the leaves. results go into a transposition
+ * table, which can be shared with other searches. moves are tried hash move first, then
+ * captures by MVV-LVA, then killers, then the rest by history score.
+ *
+ * the search stops on whatever comes first of the depth, node and time limits or stop (),
+ * which is safe to call from another thread.
+ *
+ * with Syzygy tablebases (see Tablebases.h) the root moves are cut down to the ones that keep
+ * the tablebase result, and positions inside the tables are scored from them rather than
+ * searched, once the fifty move counter has just been reset.
+ *
+ * for lazy smp several Searches run at once on the same position, sharing the transposition
+ * table. the main one (id 0) keeps the clock, reports and picks the move. helpers (id > 0) skip
+ * some depths so the threads spread out over the tree, and run until they're stopped.
+ *
+ * each Search counts what it does in Stats, plain counters that only its own thread touches,
+ * so counting costs an increment and nothing else. getStats adds the helpers' in once they've
+ * stopped. with tracing on, each also keeps the times and counts of its iterations, which
+ * writeTrace turns into a Chrome trace (chrome://tracing, Perfetto) with a row per thread.
+ */
+
+class Search
+{
+  public:
+  enum
+  {
+    MAX_PLY = 128,
+    INFINITE = 32001,
+    MATE = 32000,
+    MATE_IN_MAX_PLY = MATE - MAX_PLY
+  };
+
+  /*what to stop on. zero means no limit*/
+  struct Limits
+  {
+    int depth = 0;
+    long long nodes = 0;
+    int moveTime = 0; //milliseconds for this move
+    int timeLeft = 0; //milliseconds left on the clock, moveTime is worked out from this
+    int increment = 0;
+    int movesToGo = 0;
+    bool infinite = false; //no limits at all, think until stop ()
+  };
+
+  /*what the search did, for finding out why it's slow*/
+  struct Stats
+  {
+    long long nodes = 0; //quiescence nodes included
+    long long qnodes = 0;
+    long long ttProbes = 0;
+    long long ttHits = 0;
+    long long ttCutoffs = 0; //hits that settled the node without a search
+    long long cutoffs = 0; //nodes where a move failed high, outside quiescence
+    long long firstMoveCutoffs = 0; //... and it was the first move tried
+    long long nullMoves = 0; //null move searches
+    long long nullMoveCutoffs = 0; //... that failed high
+    long long reductions = 0; //late moves searched reduced
+    long long reSearches = 0; //... that failed high and were searched again at full depth
+    long long evals = 0;
+
+    void add (const Stats&other);
+    void subtract (const Stats&other);
+    std::string toString ();
+  };
+
+  /*an iteration one thread finished, for the trace*/
+  struct Iteration
+  {
+    int depth;
+    int score;
+    long long start; //microseconds, steady clock
+    long long duration;
+    Stats stats; //counts for this iteration alone
+  };
+
+  /*reported after each completed iteration*/
+  struct Info
+  {
+    int depth;
+    int selectiveDepth;
+    int score;
+    long long nodes;
+    int time; //milliseconds
+    int hashfull; //per mille
+    std::vector<Move>pv;
+    Stats stats; //the main search's so far, not the helpers'
+  };
+
+  typedef std::function<void (Info&)> InfoCallback;
+
+  Search (TranspositionTable*tt, int id = 0);
+  Move think (PieceList&position, Limits limits, InfoCallback callback = nullptr);
+  void stop ();
+  long long getNodes ();
+  Stats getStats ();
+  static void writeTrace (std::ostream&out, Search*main);
+
+  /*the helpers whose nodes count against the main search's node limit and reports*/
+  void setHelpers (std::vector<Search*>*helpers)
+  {
+    this->helpers = helpers;
+  }
+
+  /*
+   * think doesn't clear its own stop flag, or a stop that comes before it gets going would
+   * be lost. whoever starts the search clears it, before anything can stop it.
+   */
+  void clearStop ()
+  {
+    stopped = false;
+  }
+
+  /*
+   * start a helper's counts over, before each search it helps with. think doesn't, so that a
+   * helper taken off a search for another and put back on keeps counting from where it was.
+   */
+  void clearStats ()
+  {
+    nodes = 0;
+    publishedNodes = 0;
+    stats = Stats ();
+    iterations.clear ();
+  }
+
+  /*keep Iterations for writeTrace, from the next think*/
+  void setTracing (bool tracing)
+  {
+    this->tracing = tracing;
+  }
+
+  int getScore ()
+  {
+    return score;
+  }
+
+  /*
+   * while pondering there are no time limits and think doesn't return before a stop, even if
+   * it runs out of depth. set it before think, and clear it from any thread on a ponderhit,
+   * which starts the clock. a search on an EnginePool is told with EnginePool::ponderhit.
+   */
+  void setPondering (bool pondering)
+  {
+    this->pondering = pondering;
+  }
+
+  bool isPondering ()
+  {
+    return pondering;
+  }
+
+  private:
+  enum
+  {
+    CHECK_INTERVAL = 2048 //nodes between looking at the clock
+  };
+
+  PieceList position;
+  TranspositionTable*tt;
+  Evaluator evaluator; //its own, for the pawn hash table
+  int id;
+  std::vector<Search*>*helpers;
+  Limits limits;
+  std::atomic<bool> stopped; //told to stop, only stop and clearStop change it
+  std::atomic<bool> pondering;
+  bool clockRunning; //false until a ponderhit, when pondering
+  int clockStart; //milliseconds into the search that the clock started
+  std::atomic<long long> publishedNodes; //nodes, as of the last check, for other threads to read
+  bool limitReached; //the node or time limit has been hit, only the search's own thread touches it
+  std::chrono::steady_clock::time_point start;
+  int optimumTime;
+  int maximumTime;
+  long long nodes;
+  Stats stats; //nodes is only copied in when they're read, see getStats
+  bool tracing;
+  std::vector<Iteration>iterations;
+  int selectiveDepth;
+  int score;
+  Move rootBestMove;
+  MoveList rootMoves;
+  bool rootInTables; //the root moves have been cut down by the tablebases
+  Move killers [MAX_PLY][2];
+  int history [12][64];
+  Move pv [MAX_PLY + 1][MAX_PLY + 1];
+  int pvLength [MAX_PLY + 1];
+  static int reductions [64][64];
+  static void initReductions ();
+
+  int search (int alpha, int beta, int depth, int ply, bool nullAllowed);
+  int quiesce (int alpha, int beta, int ply);
+  int evaluate ()
+  {
+    stats.evals++;
+    return evaluator.evaluate (position);
+  }
+  void scoreMoves (MoveList&moves, int*scores, Move best, int ply);
+  Move pickMove (MoveList&moves, int*scores, int i);
+  void updateQuietStats (Move move, Move*quiets, int quietCount, int depth, int ply);
+  bool isDraw ();
+  bool probeTablebases (int ply, int&value, TranspositionTable::Bound&bound);
+  static int scoreToTable (int score, int ply);
+  static int scoreFromTable (int score, int ply);
+  void allocateTime ();
+  int elapsed ();
+  int clockTime ();
+  void checkLimits ();
+
+  bool isStopped ()
+  {
+    return stopped || limitReached;
+  }
+  bool skipDepth (int depth);
+  static long long now ();
+};
+
+#endif // Search_h
@@ -0,0 +1,51 @@
+#include <QFormLayout>
+#include "StatsPanel.h"
+
+StatsPanel::StatsPanel (QWidget*parent) : QWidget (parent, Qt::Tool)
+{
+  setWindowTitle (tr ("Search Statistics"));
+
+  const char*names [ROWS] = {QT_TR_NOOP ("Nodes:"), QT_TR_NOOP ("Quiescence nodes:"), QT_TR_NOOP ("Hash hits:"),
+                             QT_TR_NOOP ("Hash cutoffs:"), QT_TR_NOOP ("First move cutoffs:"), QT_TR_NOOP ("Null move cutoffs:"),
+                             QT_TR_NOOP ("Reductions kept:"), QT_TR_NOOP ("Evaluations:")};
+  QFormLayout*layout = new QFormLayout (this);
+  for (int i = 0; i < ROWS; i++)
+  {
+    values [i] = new QLabel ("-", this);
+    values [i]->setAlignment (Qt::AlignRight);
+    layout->addRow (tr (names [i]), values [i]);
+  }
+}
+
+/*
+ * show the panel, up against window's right edge the first time
+ */
+
+void StatsPanel::showBeside (QWidget*window)
+{
+  if (!isVisible ())
+    move (window->frameGeometry ().topRight () + QPoint (8, 0));
+  show ();
+  raise ();
+}
+
+static QString percent (long long part, long long whole)
+{
+  return whole > 0 ? QString::number (100.0 * part / whole, 'f', 1) + "%" : QString ("-");
+}
+
+/*
+ * slot, the counts of the search that just finished
+ */
+
+void StatsPanel::setStats (const Search::Stats&stats)
+{
+  values [0]->setText (QString::number (stats.nodes));
+  values [1]->setText (QString::number (stats.qnodes) + " (" + percent (stats.qnodes, stats.nodes) + ")");
+  values [2]->setText (percent (stats.ttHits, stats.ttProbes));
+  values [3]->setText (percent (stats.ttCutoffs, stats.ttProbes));
+  values [4]->setText (percent (stats.firstMoveCutoffs, stats.cutoffs));
+  values [5]->setText (percent (stats.nullMoveCutoffs, stats.nullMoves) + tr (" of %1").arg (stats.nullMoves));
+  values [6]->setText (percent (stats.reductions - stats.reSearches, stats.reductions) + tr (" of %1").arg (stats.reductions));
+  values [7]->setText (QString::number (stats.evals));
+}
@@ -0,0 +1,34 @@
+#ifndef StatsPanel_h
+#define StatsPanel_h
+
+#include <QWidget>
+#include <QLabel>
+#include "Search.h"
+
+/*
+ * a small window beside a board showing what its engine's last search did (see Search::Stats):
+ * how much of it was quiescence, how often the hash table and the pruning paid off and how
+ * good the move ordering was. it's a tool window of its own rather than part of the board
+ * window, which has to stay square.
+ */
+
+class StatsPanel : public QWidget
+{
+  Q_OBJECT
+
+  public:
+  explicit StatsPanel (QWidget*parent);
+  void showBeside (QWidget*window);
+
+  public slots:
+  void setStats (const Search::Stats&stats);
+
+  private:
+  enum
+  {
+    ROWS = 8
+  };
+  QLabel*values [ROWS];
+};
+
+#endif // StatsPanel_h
@@ -0,0 +1,1204 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Tablebases.h"
+#include "MoveGenerator.h"
+#include "MappedFile.h"
+#include "Attacks.h"
+
+/*
+ * Syzygy tables. see Tablebases.h.
+ *
+ * inside a table pieces are coded the way the generator codes them: 1-6 white pawn..king,
+ * 9-14 black pawn..king. squares are numbered the same as ours, a1 = 0. a table is for one
+ * material, with the stronger side as white; positions with the colors the other way around
+ * are looked up with the board flipped.
+ */
+
+int Tablebases::maxPieces = 0;
+
+enum
+{
+  TB_PIECES = 7,
+  WDL_TABLE = 0,
+  DTZ_TABLE = 1,
+  MAX_DTZ = 1 << 18 //above any dtz plus the fifty move counter, for ranking root moves
+};
+
+/*flags byte of each table*/
+enum
+{
+  STM = 1,
+  MAPPED = 2,
+  WIN_PLIES = 4,
+  LOSS_PLIES = 8,
+  WIDE = 16,
+  SINGLE_VALUE = 128
+};
+
+/*outcome of a probe, besides the value*/
+enum ProbeState
+{
+  FAIL = 0,
+  OK = 1,
+  CHANGE_STM = -1, //DTZ table only has the other side to move
+  ZEROING_BEST_MOVE = 2 //the best move is a capture or pawn move, there's no DTZ for it
+};
+
+static int mapPawns [64];
+static int mapB1H1H7 [64];
+static int mapA1D1D4 [64];
+static int mapKK [10][64];
+static int binomial [6][64]; //[k][n] ways to choose k from n
+static int leadPawnIdx [6][64]; //[lead pawn count][square]
+static int leadPawnsSize [6][4]; //[lead pawn count][file a..d]
+
+/*little and big endian numbers from the file, at any alignment*/
+static int readLe16 (unsigned char*p)
+{
+  return p [0] | (p [1] << 8);
+}
+
+static uint32_t readLe32 (unsigned char*p)
+{
+  return p [0] | (p [1] << 8) | (p [2] << 16) | ((uint32_t) p [3] << 24);
+}
+
+static uint32_t readBe32 (unsigned char*p)
+{
+  return ((uint32_t) p [0] << 24) | (p [1] << 16) | (p [2] << 8) | p [3];
+}
+
+static uint64_t readBe64 (unsigned char*p)
+{
+  return ((uint64_t) readBe32 (p) << 32) | readBe32 (p + 4);
+}
+
+static int fileOf (int square)
+{
+  return square & 7;
+}
+
+static int rankOf (int square)
+{
+  return square >> 3;
+}
+
+/*which side of the a1-h8 diagonal a square is on, 0 on it*/
+static int offA1H8 (int square)
+{
+  return rankOf (square) - fileOf (square);
+}
+
+static bool pawnsCompare (int a, int b)
+{
+  return mapPawns [a] < mapPawns [b];
+}
+
+/*a piece in the generator's coding*/
+static int tbPiece (PieceList::Piece piece)
+{
+  return (PieceList::getType (piece) + 1) | (PieceList::getColor (piece) == PieceList::Black ? 8 : 0);
+}
+
+/*
+ * a key for a material balance: 4 bits of count for each of the 12 pieces. counts [color][type].
+ */
+
+static uint64_t materialKey (int counts [2][6])
+{
+  uint64_t key = 0;
+  for (int c = 0; c < 2; c++)
+    for (int t = 0; t < 6; t++)
+      key |= (uint64_t) counts [c][t] << (4 * (6 * c + t));
+  return key;
+}
+
+static uint64_t materialKey (PieceList&position)
+{
+  int counts [2][6];
+  for (int c = 0; c < 2; c++)
+    for (int t = 0; t < 6; t++)
+      counts [c][t] = position.count (PieceList::makePiece ((PieceList::PieceType) t, (PieceList::Color) c));
+  return materialKey (counts);
+}
+
+/*
+ * the decoding information for one of the value tables in a file. there's one per side to
+ * move (if the file has both) and, with pawns, per file of the leading pawn, a to d.
+ */
+
+struct PairsData
+{
+  int flags;
+  size_t sizeofBlock;
+  size_t span; //there's a sparse index entry about every span values
+  int numBlocks;
+  int maxSymLen;
+  int minSymLen;
+  unsigned char*lowestSym; //le16 [] the lowest symbol of each length
+  unsigned char*btree; //3 bytes per symbol, the pair it stands for
+  unsigned char*blockLength; //le16 [] values in each block, minus one
+  int blockLengthSize;
+  unsigned char*sparseIndex; //6 bytes per entry, le32 block and le16 offset
+  size_t sparseIndexSize;
+  unsigned char*data; //the huffman coded blocks
+  std::vector<uint64_t>base64;
+  std::vector<uint8_t>symlen; //values a symbol stands for, minus one
+  int pieces [TB_PIECES]; //the order pieces are encoded in
+  uint64_t groupIdx [TB_PIECES + 1];
+  int groupLen [TB_PIECES + 1];
+  int mapIdx [4]; //where the dtz value maps start, for win, loss, cursed win and blessed loss
+
+  int left (int sym)
+  {
+    unsigned char*lr = btree + 3 * sym;
+    return ((lr [1] & 0xF) << 8) | lr [0];
+  }
+
+  int right (int sym)
+  {
+    unsigned char*lr = btree + 3 * sym;
+    return (lr [2] << 4) | (lr [1] >> 4);
+  }
+};
+
+/*
+ * one .rtbw or .rtbz file. everything but the material is filled in when it's first probed.
+ */
+
+struct Table
+{
+  int type;
+  std::string name; //like KRvK
+  uint64_t key; //material with the stronger side white
+  uint64_t key2; //and black
+  int pieceCount;
+  bool hasPawns;
+  bool hasUniquePieces;
+  int pawnCount [2]; //leading color, other
+  std::atomic<bool> ready;
+  bool usable;
+  MappedFile file;
+  unsigned char*map; //dtz value maps
+  PairsData items [2][4]; //[side to move][file a..d, or 0]
+
+  Table () : ready (false), usable (false), map (0)
+  {
+  }
+
+  int getSides ()
+  {
+    return type == WDL_TABLE && key != key2 ? 2 : 1;
+  }
+
+  PairsData*get (int stm, int file)
+  {
+    return &items [stm % (type == WDL_TABLE ? 2 : 1)][hasPawns ? file : 0];
+  }
+};
+
+static std::deque<Table>tables;
+static std::unordered_map<uint64_t, std::pair<Table*, Table*>>tableIndex; //material key to wdl, dtz
+static std::vector<std::string>directories;
+static std::mutex mapMutex;
+
+/*
+ * find the value at idx. the values are huffman coded symbols in fixed size blocks, and each
+ * symbol stands for a pair of symbols (recursively) so it can be up to 256 values. the sparse
+ * index gets close to the right block, the block lengths get the rest of the way, then it's
+ * symbols until the one covering idx, which is expanded down to the value.
+ */
+
+static int decompressPairs (PairsData*d, uint64_t idx)
+{
+  if (d->flags & SINGLE_VALUE)
+    return d->minSymLen;
+
+  uint32_t k = (uint32_t) (idx / d->span);
+  unsigned char*sparse = d->sparseIndex + 6 * (size_t) k;
+  uint32_t block = readLe32 (sparse);
+  int offset = readLe16 (sparse + 4);
+
+  offset += (int) (idx % d->span) - (int) (d->span / 2);
+  while (offset < 0)
+    offset += readLe16 (d->blockLength + 2 * (size_t) --block) + 1;
+  while (offset > readLe16 (d->blockLength + 2 * (size_t) block))
+    offset -= readLe16 (d->blockLength + 2 * (size_t) block++) + 1;
+
+  unsigned char*ptr = d->data + (uint64_t) block * d->sizeofBlock;
+  uint64_t buf64 = readBe64 (ptr);
+  ptr += 8;
+  int buf64Size = 64;
+  int sym;
+
+  while (true)
+  {
+    /*longer codes have lower values, base64 [len] is the lowest code of each length*/
+    int len = 0;
+    while (buf64 < d->base64 [len])
+      len++;
+
+    sym = (int) ((buf64 - d->base64 [len]) >> (64 - len - d->minSymLen));
+    sym += readLe16 (d->lowestSym + 2 * len);
+
+    if (offset < d->symlen [sym] + 1)
+      break;
+
+    offset -= d->symlen [sym] + 1;
+    len += d->minSymLen;
+    buf64 <<= len;
+    buf64Size -= len;
+
+    if (buf64Size <= 32)
+    {
+      buf64Size += 32;
+      buf64 |= (uint64_t) readBe32 (ptr) << (64 - buf64Size);
+      ptr += 4;
+    }
+  }
+
+  /*the values of a pair are its left symbol's, then its right's*/
+  while (d->symlen [sym])
+  {
+    int left = d->left (sym);
+    if (offset < d->symlen [left] + 1)
+      sym = left;
+    else
+    {
+      offset -= d->symlen [left] + 1;
+      sym = d->right (sym);
+    }
+  }
+  return d->left (sym);
+}
+
+/*
+ * a dtz table can be for one side to move only. a symmetric pawnless one covers both.
+ */
+
+static bool checkDtzStm (Table*t, int stm, int file)
+{
+  if (t->type == WDL_TABLE)
+    return true;
+  int flags = t->get (stm, file)->flags;
+  return (flags & STM) == stm || (t->key == t->key2 && !t->hasPawns);
+}
+
+/*
+ * turn a stored value into wdl (-2..2), or dtz in plies. dtz values are stored by how often
+ * they occur, mapped back here, and sometimes in moves rather than plies.
+ */
+
+static int mapScore (Table*t, int file, int value, int wdl)
+{
+  if (t->type == WDL_TABLE)
+    return value - 2;
+
+  static int wdlMap [] = {1, 3, 0, 2, 0};
+  PairsData*d = t->get (0, file);
+
+  if (d->flags & MAPPED)
+  {
+    int i = d->mapIdx [wdlMap [wdl + 2]] + value;
+    value = d->flags & WIDE ? readLe16 (t->map + 2 * i) : t->map [i];
+  }
+
+  if ((wdl == Tablebases::Win && !(d->flags & WIN_PLIES)) ||
+      (wdl == Tablebases::Loss && !(d->flags & LOSS_PLIES)) ||
+      wdl == Tablebases::CursedWin || wdl == Tablebases::BlessedLoss)
+    value *= 2;
+
+  return value + 1;
+}
+
+/*
+ * work out position's index in table t and look it up. the board is flipped so the stronger
+ * side is white, then mirrored so the leading piece (or pawn) is in a corner triangle (or on
+ * files a to d), then each group of like pieces is encoded as a combination of squares.
+ */
+
+static int probeTable (PieceList&position, Table*t, int wdl, ProbeState&result)
+{
+  int squares [TB_PIECES];
+  int pieces [TB_PIECES];
+  uint64_t idx;
+  int next = 0, size = 0, leadPawnsCount = 0;
+  Bitboard b, leadPawns = 0;
+  int tbFile = 0;
+  int sideToMove = position.getSideToMove () == PieceList::Black ? 1 : 0;
+
+  bool symmetricBlackToMove = t->key == t->key2 && sideToMove;
+  bool blackStronger = materialKey (position) != t->key;
+  bool flip = symmetricBlackToMove || blackStronger;
+  int flipColor = flip ? 8 : 0;
+  int flipSquares = flip ? 56 : 0;
+  int stm = (flip ? 1 : 0) ^ sideToMove;
+
+  if (t->hasPawns)
+  {
+    /*
+     * the leading pawns are the first pieces in every one of the tables. if they aren't, the
+     * file is bad, and the search can't have a throw from here, so it's a failed probe.
+     */
+    int pc = t->get (0, 0)->pieces [0] ^ flipColor;
+    if ((pc & 7) != 1)
+    {
+      result = FAIL;
+      return 0;
+    }
+
+    leadPawns = b = position.getPieces (PieceList::Pawn, (pc >> 3) ? PieceList::Black : PieceList::White);
+    do
+      squares [size++] = Bitboards::popLsb (b) ^ flipSquares;
+    while (b);
+    leadPawnsCount = size;
+
+    std::swap (squares [0], *std::max_element (squares, squares + leadPawnsCount, pawnsCompare));
+
+    tbFile = fileOf (squares [0]);
+    if (tbFile > 3)
+      tbFile = fileOf (squares [0] ^ 7);
+  }
+
+  if (!checkDtzStm (t, stm, tbFile))
+  {
+    result = CHANGE_STM;
+    return 0;
+  }
+
+  b = position.getOccupied () ^ leadPawns;
+  do
+  {
+    int s = Bitboards::popLsb (b);
+    squares [size] = s ^ flipSquares;
+    pieces [size++] = tbPiece (position.getPiece (s)) ^ flipColor;
+  }
+  while (b);
+
+  PairsData*d = t->get (stm, tbFile);
+
+  /*put the pieces in the order the table encodes them*/
+  for (int i = leadPawnsCount; i < size - 1; i++)
+    for (int j = i + 1; j < size; j++)
+      if (d->pieces [i] == pieces [j])
+      {
+        std::swap (pieces [i], pieces [j]);
+        std::swap (squares [i], squares [j]);
+        break;
+      }
+
+  if (fileOf (squares [0]) > 3)
+    for (int i = 0; i < size; i++)
+      squares [i] ^= 7;
+
+  if (t->hasPawns)
+  {
+    idx = leadPawnIdx [leadPawnsCount][squares [0]];
+    std::stable_sort (squares + 1, squares + leadPawnsCount, pawnsCompare);
+    for (int i = 1; i < leadPawnsCount; i++)
+      idx += binomial [i][mapPawns [squares [i]]];
+  }
+  else
+  {
+    /*the leading piece goes below rank 5, then below the a1-h8 diagonal*/
+    if (rankOf (squares [0]) > 3)
+      for (int i = 0; i < size; i++)
+        squares [i] ^= 56;
+
+    for (int i = 0; i < d->groupLen [0]; i++)
+    {
+      if (!offA1H8 (squares [i]))
+        continue;
+      if (offA1H8 (squares [i]) > 0)
+        for (int j = i; j < size; j++)
+          squares [j] = ((squares [j] >> 3) | (squares [j] << 3)) & 63;
+      break;
+    }
+
+    if (t->hasUniquePieces)
+    {
+      /*three unique pieces, kings included, are encoded together*/
+      int adjust1 = squares [1] > squares [0];
+      int adjust2 = (squares [2] > squares [0]) + (squares [2] > squares [1]);
+
+      if (offA1H8 (squares [0]))
+        idx = ((uint64_t) mapA1D1D4 [squares [0]] * 63 + (squares [1] - adjust1)) * 62 + squares [2] - adjust2;
+      else if (offA1H8 (squares [1]))
+        idx = ((uint64_t) 6 * 63 + rankOf (squares [0]) * 28 + mapB1H1H7 [squares [1]]) * 62 + squares [2] - adjust2;
+      else if (offA1H8 (squares [2]))
+        idx = 6 * 63 * 62 + 4 * 28 * 62 + rankOf (squares [0]) * 7 * 28 +
+              (rankOf (squares [1]) - adjust1) * 28 + mapB1H1H7 [squares [2]];
+      else
+        idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf (squares [0]) * 7 * 6 +
+              (rankOf (squares [1]) - adjust1) * 6 + (rankOf (squares [2]) - adjust2);
+    }
+    else
+      idx = mapKK [mapA1D1D4 [squares [0]]][squares [1]];
+  }
+
+  idx *= d->groupIdx [0];
+  int*groupSq = squares + d->groupLen [0];
+
+  /*the rest of the groups, each as a combination of the squares left for it*/
+  bool remainingPawns = t->hasPawns && t->pawnCount [1];
+  while (d->groupLen [++next])
+  {
+    std::stable_sort (groupSq, groupSq + d->groupLen [next]);
+    uint64_t n = 0;
+
+    for (int i = 0; i < d->groupLen [next]; i++)
+    {
+      int adjust = 0;
+      for (int*s = squares; s < groupSq; s++)
+        adjust += groupSq [i] > *s;
+      n += binomial [i + 1][groupSq [i] - adjust - 8 * remainingPawns];
+    }
+
+    remainingPawns = false;
+    idx += n * d->groupIdx [next];
+    groupSq += d->groupLen [next];
+  }
+
+  result = OK;
+  return mapScore (t, tbFile, decompressPairs (d, idx), wdl);
+}
+
+/*
+ * work out the groups pieces are encoded in and the multiplier for each. a group is pieces
+ * of the same kind, except the leading group: the leading pawns, or without pawns the first
+ * three pieces if some piece is unique, or just the kings.
+ */
+
+static void setGroups (Table&t, PairsData*d, int order [2], int file)
+{
+  int n = 0, firstLen = t.hasPawns ? 0 : t.hasUniquePieces ? 3 : 2;
+  d->groupLen [n] = 1;
+
+  for (int i = 1; i < t.pieceCount; i++)
+    if (--firstLen > 0 || d->pieces [i] == d->pieces [i - 1])
+      d->groupLen [n]++;
+    else
+      d->groupLen [++n] = 1;
+  d->groupLen [++n] = 0;
+
+  /*the groups aren't necessarily multiplied in the order they come in, order says*/
+  bool pp = t.hasPawns && t.pawnCount [1];
+  int next = pp ? 2 : 1;
+  int freeSquares = 64 - d->groupLen [0] - (pp ? d->groupLen [1] : 0);
+  uint64_t idx = 1;
+
+  for (int k = 0; next < n || k == order [0] || k == order [1]; k++)
+  {
+    if (k == order [0])
+    {
+      d->groupIdx [0] = idx;
+      idx *= t.hasPawns ? leadPawnsSize [d->groupLen [0]][file] : t.hasUniquePieces ? 31332 : 462;
+    }
+    else if (k == order [1])
+    {
+      d->groupIdx [1] = idx;
+      idx *= binomial [d->groupLen [1]][48 - d->groupLen [0]];
+    }
+    else
+    {
+      d->groupIdx [next] = idx;
+      idx *= binomial [d->groupLen [next]][freeSquares];
+      freeSquares -= d->groupLen [next++];
+    }
+  }
+  d->groupIdx [n] = idx;
+}
+
+/*
+ * how many values symbol s stands for, minus one, working down its pairs
+ */
+
+static int setSymlen (PairsData*d, int s, std::vector<bool>&visited)
+{
+  visited [s] = true;
+  int sr = d->right (s);
+  if (sr == 0xFFF)
+    return 0;
+
+  int sl = d->left (s);
+  if (!visited [sl])
+    d->symlen [sl] = (uint8_t) setSymlen (d, sl, visited);
+  if (!visited [sr])
+    d->symlen [sr] = (uint8_t) setSymlen (d, sr, visited);
+  return d->symlen [sl] + d->symlen [sr] + 1;
+}
+
+/*
+ * read a table's huffman code and block layout starting at data, return where it ends
+ */
+
+static unsigned char*setSizes (PairsData*d, unsigned char*data)
+{
+  d->flags = *data++;
+
+  if (d->flags & SINGLE_VALUE)
+  {
+    d->numBlocks = d->blockLengthSize = 0;
+    d->span = d->sparseIndexSize = 0;
+    d->minSymLen = *data++; //the value
+    return data;
+  }
+
+  int groups = 0;
+  while (d->groupLen [groups])
+    groups++;
+  uint64_t tbSize = d->groupIdx [groups];
+
+  d->sizeofBlock = (size_t) 1 << *data++;
+  d->span = (size_t) 1 << *data++;
+  d->sparseIndexSize = (size_t) ((tbSize + d->span - 1) / d->span);
+  int padding = *data++;
+  d->numBlocks = (int) readLe32 (data);
+  data += 4;
+  d->blockLengthSize = d->numBlocks + padding;
+  d->maxSymLen = *data++;
+  d->minSymLen = *data++;
+  d->lowestSym = data;
+  d->base64.assign (d->maxSymLen - d->minSymLen + 1, 0);
+
+  /*canonical huffman: the lowest code of each length, as the top bits of 64*/
+  for (int i = (int) d->base64.size () - 2; i >= 0; i--)
+    d->base64 [i] = (d->base64 [i + 1] + readLe16 (d->lowestSym + 2 * i) - readLe16 (d->lowestSym + 2 * (i + 1))) / 2;
+  for (size_t i = 0; i < d->base64.size (); i++)
+    d->base64 [i] <<= 64 - i - d->minSymLen;
+
+  data += d->base64.size () * 2;
+  d->symlen.assign (readLe16 (data), 0);
+  data += 2;
+  d->btree = data;
+
+  std::vector<bool>visited (d->symlen.size ());
+  for (size_t s = 0; s < d->symlen.size (); s++)
+    if (!visited [s])
+      d->symlen [s] = (uint8_t) setSymlen (d, (int) s, visited);
+
+  return data + d->symlen.size () * 3 + (d->symlen.size () & 1);
+}
+
+/*
+ * dtz tables map their stored values back to distances, one map per wdl result
+ */
+
+static unsigned char*setDtzMap (Table&t, unsigned char*data, int maxFile)
+{
+  if (t.type == WDL_TABLE)
+    return data;
+
+  t.map = data;
+  for (int f = 0; f <= maxFile; f++)
+  {
+    PairsData*d = t.get (0, f);
+    if (!(d->flags & MAPPED))
+      continue;
+
+    if (d->flags & WIDE)
+    {
+      data += (uintptr_t) data & 1;
+      for (int i = 0; i < 4; i++)
+      {
+        d->mapIdx [i] = (int) ((data - t.map) / 2 + 1);
+        data += 2 * readLe16 (data) + 2;
+      }
+    }
+    else
+    {
+      for (int i = 0; i < 4; i++)
+      {
+        d->mapIdx [i] = (int) (data - t.map + 1);
+        data += *data + 1;
+      }
+    }
+  }
+  return data + ((uintptr_t) data & 1);
+}
+
+/*
+ * set up all of t's tables from its file's header, data being just past the magic number
+ */
+
+static void setup (Table&t, unsigned char*data)
+{
+  data++; //split and has pawns flags, which we know already
+
+  int sides = t.getSides ();
+  int maxFile = t.hasPawns ? 3 : 0;
+  bool pp = t.hasPawns && t.pawnCount [1];
+
+  for (int f = 0; f <= maxFile; f++)
+  {
+    for (int i = 0; i < sides; i++)
+      *t.get (i, f) = PairsData ();
+
+    int order [2][2] = {{*data & 0xF, pp ? *(data + 1) & 0xF : 0xF},
+                        {*data >> 4, pp ? *(data + 1) >> 4 : 0xF}};
+    data += 1 + pp;
+
+    for (int k = 0; k < t.pieceCount; k++, data++)
+      for (int i = 0; i < sides; i++)
+        t.get (i, f)->pieces [k] = i ? *data >> 4 : *data & 0xF;
+
+    for (int i = 0; i < sides; i++)
+      setGroups (t, t.get (i, f), order [i], f);
+  }
+
+  data += (uintptr_t) data & 1;
+
+  for (int f = 0; f <= maxFile; f++)
+    for (int i = 0; i < sides; i++)
+      data = setSizes (t.get (i, f), data);
+
+  data = setDtzMap (t, data, maxFile);
+
+  for (int f = 0; f <= maxFile; f++)
+    for (int i = 0; i < sides; i++)
+    {
+      PairsData*d = t.get (i, f);
+      d->sparseIndex = data;
+      data += d->sparseIndexSize * 6;
+    }
+
+  for (int f = 0; f <= maxFile; f++)
+    for (int i = 0; i < sides; i++)
+    {
+      PairsData*d = t.get (i, f);
+      d->blockLength = data;
+      data += (size_t) d->blockLengthSize * 2;
+    }
+
+  for (int f = 0; f <= maxFile; f++)
+    for (int i = 0; i < sides; i++)
+    {
+      data = (unsigned char*) (((uintptr_t) data + 0x3F) & ~(uintptr_t) 0x3F);
+      PairsData*d = t.get (i, f);
+      d->data = data;
+      data += (size_t) d->numBlocks * d->sizeofBlock;
+    }
+}
+
+/*
+ * map t's file and set it up, the first time it's needed. returns whether it can be used.
+ */
+
+static bool prepare (Table&t)
+{
+  if (t.ready.load (std::memory_order_acquire))
+    return t.usable;
+
+  std::lock_guard<std::mutex> lock (mapMutex);
+  if (t.ready.load (std::memory_order_relaxed))
+    return t.usable;
+
+  static unsigned char magics [2][4] = {{0xD7, 0x66, 0x0C, 0xA5}, {0x71, 0xE8, 0x23, 0x5D}};
+  std::string fileName = t.name + (t.type == WDL_TABLE ? ".rtbw" : ".rtbz");
+
+  for (std::string&dir : directories)
+    if (t.file.open (dir + "/" + fileName, MappedFile::Random))
+      break;
+
+  if (t.file.isOpen ())
+  {
+    if (t.file.getSize () % 64 == 16 && memcmp (t.file.getData (), magics [t.type], 4) == 0)
+    {
+      setup (t, t.file.getData () + 4);
+      t.usable = true;
+    }
+    else
+    {
+      fprintf (stderr, "corrupt tablebase %s\n", fileName.c_str ());
+      t.file.close ();
+    }
+  }
+
+  t.ready.store (true, std::memory_order_release);
+  return t.usable;
+}
+
+static int probeTable (PieceList&position, int type, int wdl, ProbeState&result)
+{
+  if (Bitboards::popCount (position.getOccupied ()) == 2)
+  {
+    result = OK;
+    return Tablebases::Draw;
+  }
+
+  auto i = tableIndex.find (materialKey (position));
+  Table*t = i == tableIndex.end () ? 0 : type == WDL_TABLE ? i->second.first : i->second.second;
+  if (!t || !prepare (*t))
+  {
+    result = FAIL;
+    return 0;
+  }
+  return probeTable (position, t, wdl, result);
+}
+
+static bool isCapture (PieceList&position, Move move)
+{
+  return position.getPiece (move.getTo ()) != PieceList::None || move.getType () == Move::EnPassant;
+}
+
+static bool isPawnMove (PieceList&position, Move move)
+{
+  return PieceList::getType (position.getPiece (move.getFrom ())) == PieceList::Pawn;
+}
+
+/*
+ * the tables don't store the right value where a capture (or with checkZeroing, a pawn move)
+ * is best, or where en passant is possible, so the result is the best of the captures and
+ * the table. sets result to ZEROING_BEST_MOVE if a capture or pawn move is the way to go.
+ */
+
+static int searchCaptures (PieceList&position, ProbeState&result, bool checkZeroing)
+{
+  int value, bestValue = Tablebases::Loss;
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+  int moveCount = 0;
+
+  for (Move move : moves)
+  {
+    if (!isCapture (position, move) && (!checkZeroing || !isPawnMove (position, move)))
+      continue;
+
+    moveCount++;
+    position.makeMove (move);
+    value = -searchCaptures (position, result, false);
+    position.unmakeMove ();
+
+    if (result == FAIL)
+      return Tablebases::Draw;
+
+    if (value > bestValue)
+    {
+      bestValue = value;
+      if (value >= Tablebases::Win)
+      {
+        result = ZEROING_BEST_MOVE;
+        return value;
+      }
+    }
+  }
+
+  /*if every move has been tried the table isn't needed, and might be wrong (en passant)*/
+  bool noMoreMoves = moveCount && moveCount == moves.getSize ();
+  if (noMoreMoves)
+    value = bestValue;
+  else
+  {
+    value = probeTable (position, WDL_TABLE, Tablebases::Draw, result);
+    if (result == FAIL)
+      return Tablebases::Draw;
+  }
+
+  if (bestValue >= value)
+  {
+    result = bestValue > Tablebases::Draw || noMoreMoves ? ZEROING_BEST_MOVE : OK;
+    return bestValue;
+  }
+  result = OK;
+  return value;
+}
+
+/*
+ * dtz of the move that zeroed the fifty move counter, from the wdl after it
+ */
+
+static int dtzBeforeZeroing (int wdl)
+{
+  return wdl == Tablebases::Win ? 1 :
+         wdl == Tablebases::CursedWin ? 101 :
+         wdl == Tablebases::BlessedLoss ? -101 :
+         wdl == Tablebases::Loss ? -1 : 0;
+}
+
+static int sign (int value)
+{
+  return (0 < value) - (value < 0);
+}
+
+static int probeDtz (PieceList&position, ProbeState&result)
+{
+  result = OK;
+  int wdl = searchCaptures (position, result, true);
+
+  if (result == FAIL || wdl == Tablebases::Draw)
+    return 0;
+  if (result == ZEROING_BEST_MOVE)
+    return dtzBeforeZeroing (wdl);
+
+  int dtz = probeTable (position, DTZ_TABLE, wdl, result);
+  if (result == FAIL)
+    return 0;
+  if (result != CHANGE_STM)
+    return (dtz + 100 * (wdl == Tablebases::BlessedLoss || wdl == Tablebases::CursedWin)) * sign (wdl);
+
+  /*the table only has the other side to move, so look one move ahead for the best dtz*/
+  int minDtz = INT_MAX;
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+
+  for (Move move : moves)
+  {
+    bool zeroing = isCapture (position, move) || isPawnMove (position, move);
+
+    position.makeMove (move);
+    dtz = zeroing ? -dtzBeforeZeroing (searchCaptures (position, result, false)) : -probeDtz (position, result);
+
+    /*a mate is dtz 1*/
+    if (dtz == 1 && MoveGenerator::inCheck (position))
+    {
+      MoveList replies;
+      MoveGenerator::generate (position, replies);
+      if (replies.getSize () == 0)
+        minDtz = 1;
+    }
+
+    if (!zeroing)
+      dtz += sign (dtz);
+    if (dtz < minDtz && sign (dtz) == sign (wdl))
+      minDtz = dtz;
+    position.unmakeMove ();
+
+    if (result == FAIL)
+      return 0;
+  }
+  return minDtz == INT_MAX ? -1 : minDtz;
+}
+
+/*
+ * add the table for the material in pieces (types, white's then black's, split at the
+ * second king) if its wdl file is in one of the directories. returns its piece count, 0
+ * if it isn't there.
+ */
+
+static int addTable (std::vector<int>pieces)
+{
+  static char pieceChars [] = "PNBRQK";
+  std::string name;
+  int counts [2][6] = {{0}};
+  int color = -1;
+
+  for (int p : pieces)
+  {
+    if (p == PieceList::King)
+    {
+      color++;
+      if (color == 1)
+        name += 'v';
+    }
+    name += pieceChars [p];
+    counts [color][p]++;
+  }
+
+  bool found = false;
+  for (std::string&dir : directories)
+  {
+    FILE*f = fopen ((dir + "/" + name + ".rtbw").c_str (), "rb");
+    if (f)
+    {
+      fclose (f);
+      found = true;
+      break;
+    }
+  }
+  if (!found)
+    return 0;
+
+  int swapped [2][6];
+  for (int t = 0; t < 6; t++)
+  {
+    swapped [0][t] = counts [1][t];
+    swapped [1][t] = counts [0][t];
+  }
+
+  tables.emplace_back ();
+  Table&wdl = tables.back ();
+  wdl.type = WDL_TABLE;
+  wdl.name = name;
+  wdl.key = materialKey (counts);
+  wdl.key2 = materialKey (swapped);
+  wdl.pieceCount = (int) pieces.size ();
+  wdl.hasPawns = counts [0][PieceList::Pawn] + counts [1][PieceList::Pawn] > 0;
+  wdl.hasUniquePieces = false;
+  for (int c = 0; c < 2; c++)
+    for (int t = PieceList::Pawn; t < PieceList::King; t++)
+      if (counts [c][t] == 1)
+        wdl.hasUniquePieces = true;
+
+  /*with pawns on both sides, the one with fewer leads*/
+  bool whiteLeads = !counts [1][PieceList::Pawn] ||
+                    (counts [0][PieceList::Pawn] && counts [1][PieceList::Pawn] >= counts [0][PieceList::Pawn]);
+  wdl.pawnCount [0] = counts [whiteLeads ? 0 : 1][PieceList::Pawn];
+  wdl.pawnCount [1] = counts [whiteLeads ? 1 : 0][PieceList::Pawn];
+
+  tables.emplace_back ();
+  Table&dtz = tables.back ();
+  dtz.type = DTZ_TABLE;
+  dtz.name = wdl.name;
+  dtz.key = wdl.key;
+  dtz.key2 = wdl.key2;
+  dtz.pieceCount = wdl.pieceCount;
+  dtz.hasPawns = wdl.hasPawns;
+  dtz.hasUniquePieces = wdl.hasUniquePieces;
+  dtz.pawnCount [0] = wdl.pawnCount [0];
+  dtz.pawnCount [1] = wdl.pawnCount [1];
+
+  tableIndex [wdl.key] = std::make_pair (&wdl, &dtz);
+  tableIndex [wdl.key2] = std::make_pair (&wdl, &dtz);
+  return wdl.pieceCount;
+}
+
+/*
+ * the index tables that don't depend on any file
+ */
+
+static void initIndexing ()
+{
+  int code = 0;
+  for (int s = 0; s < 64; s++)
+    if (offA1H8 (s) < 0)
+      mapB1H1H7 [s] = code++;
+
+  std::vector<int>diagonal;
+  code = 0;
+  for (int s = 0; s <= 27; s++) //a1..d4
+  {
+    if (offA1H8 (s) < 0 && fileOf (s) <= 3)
+      mapA1D1D4 [s] = code++;
+    else if (!offA1H8 (s) && fileOf (s) <= 3)
+      diagonal.push_back (s);
+  }
+  for (int s : diagonal)
+    mapA1D1D4 [s] = code++;
+
+  /*the 462 ways to put two kings with the first in the a1-d1-d4 triangle*/
+  std::vector<std::pair<int, int>>bothOnDiagonal;
+  code = 0;
+  for (int idx = 0; idx < 10; idx++)
+    for (int s1 = 0; s1 <= 27; s1++)
+      if (mapA1D1D4 [s1] == idx && (idx || s1 == 1)) //b1 is 0
+      {
+        for (int s2 = 0; s2 < 64; s2++)
+        {
+          if ((Attacks::king (s1) | Bitboards::bit (s1)) & Bitboards::bit (s2))
+            continue;
+          else if (!offA1H8 (s1) && offA1H8 (s2) > 0)
+            continue;
+          else if (!offA1H8 (s1) && !offA1H8 (s2))
+            bothOnDiagonal.push_back (std::make_pair (idx, s2));
+          else
+            mapKK [idx][s2] = code++;
+        }
+      }
+  for (auto&p : bothOnDiagonal)
+    mapKK [p.first][p.second] = code++;
+
+  binomial [0][0] = 1;
+  for (int n = 1; n < 64; n++)
+    for (int k = 0; k < 6 && k <= n; k++)
+      binomial [k][n] = (k > 0 ? binomial [k - 1][n - 1] : 0) + (k < n ? binomial [k][n - 1] : 0);
+
+  /*pawns are a2..h7, the leading pawn is the one nearest the edge, then the lowest*/
+  int availableSquares = 47;
+  for (int leadPawnsCount = 1; leadPawnsCount <= 5; leadPawnsCount++)
+    for (int f = 0; f <= 3; f++)
+    {
+      int idx = 0;
+      for (int r = 1; r <= 6; r++)
+      {
+        int sq = 8 * r + f;
+        if (leadPawnsCount == 1)
+        {
+          mapPawns [sq] = availableSquares--;
+          mapPawns [sq ^ 7] = availableSquares--;
+        }
+        leadPawnIdx [leadPawnsCount][sq] = idx;
+        idx += binomial [leadPawnsCount - 1][mapPawns [sq]];
+      }
+      leadPawnsSize [leadPawnsCount][f] = idx;
+    }
+}
+
+/*
+ * look for tables in paths, a list of directories separated by ':' (';' on windows).
+ * forgets any tables found before, so it can't be called during a search. an empty path
+ * turns tablebases off.
+ */
+
+void Tablebases::init (std::string paths)
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    Attacks::init ();
+    initIndexing ();
+  });
+
+  tableIndex.clear ();
+  tables.clear ();
+  directories.clear ();
+  maxPieces = 0;
+
+  if (paths.empty () || paths == "<empty>")
+    return;
+
+#if defined(_WIN32)
+  char separator = ';';
+#else
+  char separator = ':';
+#endif
+  size_t start = 0;
+  while (start <= paths.size ())
+  {
+    size_t end = paths.find (separator, start);
+    if (end == std::string::npos)
+      end = paths.size ();
+    if (end > start)
+      directories.push_back (paths.substr (start, end - start));
+    start = end + 1;
+  }
+
+  /*every material up to 7 pieces, stronger side first and pieces in decreasing order*/
+  int K = PieceList::King;
+  for (int p1 = PieceList::Pawn; p1 < K; p1++)
+  {
+    maxPieces = std::max (maxPieces, addTable ({K, p1, K}));
+    for (int p2 = PieceList::Pawn; p2 <= p1; p2++)
+    {
+      maxPieces = std::max (maxPieces, addTable ({K, p1, p2, K}));
+      maxPieces = std::max (maxPieces, addTable ({K, p1, K, p2}));
+
+      for (int p3 = PieceList::Pawn; p3 < K; p3++)
+        maxPieces = std::max (maxPieces, addTable ({K, p1, p2, K, p3}));
+
+      for (int p3 = PieceList::Pawn; p3 <= p2; p3++)
+      {
+        maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, K}));
+
+        for (int p4 = PieceList::Pawn; p4 <= p3; p4++)
+        {
+          maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, p4, K}));
+          for (int p5 = PieceList::Pawn; p5 <= p4; p5++)
+            maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, p4, p5, K}));
+          for (int p5 = PieceList::Pawn; p5 < K; p5++)
+            maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, p4, K, p5}));
+        }
+
+        for (int p4 = PieceList::Pawn; p4 < K; p4++)
+        {
+          maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, K, p4}));
+          for (int p5 = PieceList::Pawn; p5 <= p4; p5++)
+            maxPieces = std::max (maxPieces, addTable ({K, p1, p2, p3, K, p4, p5}));
+        }
+      }
+
+      for (int p3 = PieceList::Pawn; p3 <= p1; p3++)
+        for (int p4 = PieceList::Pawn; p4 <= (p1 == p3 ? p2 : p3); p4++)
+        {
+          maxPieces = std::max (maxPieces, addTable ({K, p1, p2, K, p3, p4}));
+          for (int p5 = PieceList::Pawn; p5 <= p4; p5++)
+            maxPieces = std::max (maxPieces, addTable ({K, p1, p2, K, p3, p4, p5}));
+        }
+    }
+  }
+}
+
+/*
+ * win/draw/loss for the side to move, -2..2 (see WDL). false if position isn't covered.
+ * positions with castling rights aren't in the tables.
+ */
+
+bool Tablebases::probeWdl (PieceList&position, int&wdl)
+{
+  if (position.getCastlingRights () || Bitboards::popCount (position.getOccupied ()) > maxPieces)
+    return false;
+
+  ProbeState result = OK;
+  wdl = searchCaptures (position, result, false);
+  return result != FAIL;
+}
+
+/*
+ * distance to zeroing the fifty move counter, in plies, for the side to move: positive if
+ * winning, negative if losing, beyond +-100 if the win or loss is spoiled by the fifty move
+ * rule, 0 for a draw. it can be one ply out. false if position isn't covered.
+ */
+
+bool Tablebases::probeDtz (PieceList&position, int&dtz)
+{
+  if (position.getCastlingRights () || Bitboards::popCount (position.getOccupied ()) > maxPieces)
+    return false;
+
+  ProbeState result = OK;
+  dtz = ::probeDtz (position, result);
+  return result != FAIL;
+}
+
+/*
+ * cut moves down to the ones that keep the best result position has, by dtz, taking the
+ * fifty move counter into account. wins that are sure inside the fifty moves are all kept,
+ * the search can pick between them. returns false, leaving moves alone, if position isn't
+ * covered.
+ */
+
+bool Tablebases::rootProbe (PieceList&position, MoveList&moves)
+{
+  if (position.getCastlingRights () || Bitboards::popCount (position.getOccupied ()) > maxPieces)
+    return false;
+
+  int halfmoveClock = position.getHalfmoveClock ();
+  bool repeated = position.isRepetition ();
+  int ranks [MoveList::MAX_MOVES];
+  int bestRank = INT_MIN;
+
+  for (int i = 0; i < moves.getSize (); i++)
+  {
+    ProbeState result = OK;
+    int dtz;
+
+    position.makeMove (moves [i]);
+    if (position.getHalfmoveClock () == 0)
+      dtz = dtzBeforeZeroing (-searchCaptures (position, result, false));
+    else
+    {
+      dtz = -::probeDtz (position, result);
+      dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+    }
+
+    if (dtz == 2 && MoveGenerator::inCheck (position))
+    {
+      MoveList replies;
+      MoveGenerator::generate (position, replies);
+      if (replies.getSize () == 0)
+        dtz = 1;
+    }
+    position.unmakeMove ();
+
+    if (result == FAIL)
+      return false;
+
+    /*sure wins rank the same, losses too unless the fifty move rule might save them*/
+    ranks [i] = dtz > 0 ? (dtz + halfmoveClock <= 99 && !repeated ? MAX_DTZ : MAX_DTZ - (dtz + halfmoveClock)) :
+                dtz < 0 ? (-dtz * 2 + halfmoveClock < 100 ? -MAX_DTZ : -MAX_DTZ + (-dtz + halfmoveClock)) : 0;
+    if (ranks [i] > bestRank)
+      bestRank = ranks [i];
+  }
+
+  MoveList best;
+  for (int i = 0; i < moves.getSize (); i++)
+    if (ranks [i] == bestRank)
+      best.add (moves [i]);
+  moves = best;
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef Tablebases_h
+#define Tablebases_h
+
+#include <string>
+#include "PieceList.h"
+#include "MoveList.h"
+
+/*
+ * Syzygy endgame tablebase probing. WDL files (.rtbw) give win/draw/loss for every position
+ * with their material, DTZ files (.rtbz) the distance to the next capture or pawn move, which
+ * is what it takes to actually win one inside the fifty move rule.
+ *
+ * init () only looks for which files exist. a file is mapped, and its tables set up, the
+ * first time a position with its material is probed, so nothing is read in for endgames
+ * that never come up, and what is mapped is the OS's page cache, not our memory. after
+ * init everything here is read-only or set up under a lock, so any number of search threads
+ * can probe at once.
+ *
+ * the table format and index scheme are Ronald de Man's. this follows the layout of the
+ * probing code in Stockfish, written out again on our PieceList and move generator.
+ */
+
+class Tablebases
+{
+  public:
+  enum WDL
+  {
+    Loss = -2,
+    BlessedLoss = -1, //lost, but drawn by the fifty move rule
+    Draw = 0,
+    CursedWin = 1, //won, but drawn by the fifty move rule
+    Win = 2
+  };
+
+  static void init (std::string paths);
+
+  /*the most pieces, kings included, of any table found, 0 if there are none*/
+  static int getMaxPieces ()
+  {
+    return maxPieces;
+  }
+
+  static bool probeWdl (PieceList&position, int&wdl);
+  static bool probeDtz (PieceList&position, int&dtz);
+  static bool rootProbe (PieceList&position, MoveList&moves);
+
+  private:
+  static int maxPieces;
+};
+
+#endif // Tablebases_h
@@ -0,0 +1,195 @@
+#include <cstdlib>
+#include <new>
+#include "TranspositionTable.h"
+#include "insist.h"
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+TranspositionTable::TranspositionTable (int megabytes) : buckets (0), bucketCount (0), megabytes (0), age (0)
+{
+  resize (megabytes);
+}
+
+TranspositionTable::~TranspositionTable ()
+{
+  release ();
+}
+
+void TranspositionTable::release ()
+{
+  if (!buckets)
+    return;
+#if defined(_WIN32)
+  _aligned_free (buckets);
+#else
+  free (buckets);
+#endif
+  buckets = 0;
+}
+
+/*
+ * get megabytes of table, lined up on a 2MB boundary so huge pages can back it
+ */
+
+void TranspositionTable::allocate (int megabytes)
+{
+  size_t bytes = (size_t) megabytes << 20;
+  size_t alignment = 2 << 20;
+  void*memory = 0;
+
+#if defined(_WIN32)
+  memory = _aligned_malloc (bytes, alignment);
+#else
+  if (posix_memalign (&memory, alignment, bytes) != 0)
+    memory = 0;
+#endif
+  if (!memory)
+    throw std::bad_alloc ();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  /*only a hint, without transparent huge pages this does nothing*/
+  madvise (memory, bytes, MADV_HUGEPAGE);
+#endif
+
+  buckets = (Bucket*) memory;
+  bucketCount = (long long) (bytes / sizeof (Bucket));
+  this->megabytes = megabytes;
+}
+
+/*
+ * throw away the table and make a new, empty, one of megabytes
+ */
+
+void TranspositionTable::resize (int megabytes)
+{
+  insist (megabytes > 0);
+
+  release ();
+  allocate (megabytes);
+  clear ();
+}
+
+/*
+ * empty the table. this also touches every page, so the memory is really there before a search.
+ */
+
+void TranspositionTable::clear ()
+{
+  for (long long i = 0; i < bucketCount; i++)
+  {
+    for (int j = 0; j < ENTRIES_PER_BUCKET; j++)
+    {
+      buckets [i].slots [j].keyXorData.store (0, std::memory_order_relaxed);
+      buckets [i].slots [j].data.store (0, std::memory_order_relaxed);
+    }
+  }
+  age = 0;
+}
+
+/*
+ * called at the start of every search so entries from earlier searches can be told apart
+ */
+
+void TranspositionTable::newSearch ()
+{
+  age = (age.load () + 1) & AGE_MASK;
+}
+
+/*
+ * look key up. returns true, and fills in entry, if it's there.
+ */
+
+bool TranspositionTable::probe (Bitboard key, Entry&entry)
+{
+  Bucket&bucket = bucketFor (key);
+
+  for (int i = 0; i < ENTRIES_PER_BUCKET; i++)
+  {
+    Slot&slot = bucket.slots [i];
+    Bitboard data = slot.data.load (std::memory_order_relaxed);
+    Bitboard check = slot.keyXorData.load (std::memory_order_relaxed);
+
+    if ((check ^ data) == key && (data >> 48 & 0xFF))
+    {
+      entry.move = Move::fromData ((int) (data & 0xFFFF));
+      entry.score = (short) (data >> 16);
+      entry.eval = (short) (data >> 32);
+      entry.depth = unpackDepth (data);
+      entry.bound = (Bound) ((data >> 56) & 3);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * save a search result. depth has to be at least -DEPTH_OFFSET + 1, scores have to fit in 16 bits.
+ */
+
+void TranspositionTable::store (Bitboard key, Move move, int score, int eval, int depth, Bound bound)
+{
+  Bucket&bucket = bucketFor (key);
+  int age = this->age.load (std::memory_order_relaxed);
+  Slot*replace = 0;
+  int replaceWorth = 1 << 30;
+
+  for (int i = 0; i < ENTRIES_PER_BUCKET; i++)
+  {
+    Slot&slot = bucket.slots [i];
+    Bitboard data = slot.data.load (std::memory_order_relaxed);
+
+    /*the same position: overwrite it, but hang on to its move if we don't have one*/
+    if ((slot.keyXorData.load (std::memory_order_relaxed) ^ data) == key)
+    {
+      if (move.isNull ())
+        move = Move::fromData ((int) (data & 0xFFFF));
+      replace = &slot;
+      break;
+    }
+
+    /*otherwise the shallowest, where each search ago costs a couple of plies*/
+    int worth = (data >> 48 & 0xFF) ? unpackDepth (data) - 2 * ((age - unpackAge (data)) & AGE_MASK) : -1000;
+    if (worth < replaceWorth)
+    {
+      replaceWorth = worth;
+      replace = &slot;
+    }
+  }
+
+  Bitboard data = (Bitboard) (move.getData () & 0xFFFF) |
+                  (Bitboard) (score & 0xFFFF) << 16 |
+                  (Bitboard) (eval & 0xFFFF) << 32 |
+                  (Bitboard) ((depth + DEPTH_OFFSET) & 0xFF) << 48 |
+                  (Bitboard) bound << 56 |
+                  (Bitboard) age << 58;
+
+  replace->keyXorData.store (key ^ data, std::memory_order_relaxed);
+  replace->data.store (data, std::memory_order_relaxed);
+}
+
+/*
+ * how full the table is in parts per thousand, guessed from how many of the first
+ * thousand entries were written during this search
+ */
+
+int TranspositionTable::hashfull ()
+{
+  int count = 0;
+  int age = this->age.load (std::memory_order_relaxed);
+  int samples = bucketCount < 250 ? (int) bucketCount : 250;
+
+  for (int i = 0; i < samples; i++)
+  {
+    for (int j = 0; j < ENTRIES_PER_BUCKET; j++)
+    {
+      Bitboard data = buckets [i].slots [j].data.load (std::memory_order_relaxed);
+      if ((data >> 48 & 0xFF) && unpackAge (data) == age)
+        count++;
+    }
+  }
+  return samples ? count * 1000 / (samples * ENTRIES_PER_BUCKET) : 0;
+}
@@ -0,0 +1,120 @@
+#ifndef TranspositionTable_h
+#define TranspositionTable_h
+
+#include <atomic>
+#include "Bitboard.h"
+#include "Move.h"
+
+/*
+ * hash table of search results keyed by Zobrist key, shared by every search thread
+ * without any locking.
+ *
+ * each entry is two 64 bit words, the packed data and the key xor'ed with the data. a reader
+ * only believes an entry if xor'ing its two words gives back the key it's looking for, so an
+ * entry torn by two threads writing at once just looks like a miss. the words are relaxed
+ * atomics, which compile to plain loads and stores.
+ *
+ * entries come in buckets of four filling a 64 byte cache line, so a probe touches one line.
+ * a store replaces the entry for the same position if there is one, otherwise the entry
+ * with the least depth, counting entries left over from earlier searches as shallower.
+ *
+ * on linux the table is allocated on a 2MB boundary and the kernel is asked to back it with
+ * huge pages, which for big tables cuts the TLB misses that random probing causes.
+ */
+
+class TranspositionTable
+{
+  public:
+  enum Bound
+  {
+    NoBound,
+    Upper, //score is at most this
+    Lower, //score is at least this
+    Exact
+  };
+
+  enum
+  {
+    DEFAULT_SIZE = 64, //megabytes
+    ENTRIES_PER_BUCKET = 4
+  };
+
+  struct Entry
+  {
+    Move move;
+    int score;
+    int eval;
+    int depth;
+    Bound bound;
+  };
+
+  TranspositionTable (int megabytes = DEFAULT_SIZE);
+  ~TranspositionTable ();
+  void resize (int megabytes);
+  void clear ();
+  void newSearch ();
+  bool probe (Bitboard key, Entry&entry);
+  void store (Bitboard key, Move move, int score, int eval, int depth, Bound bound);
+  int hashfull ();
+
+  int getSize ()
+  {
+    return megabytes;
+  }
+
+  private:
+  struct Slot
+  {
+    std::atomic<Bitboard> keyXorData;
+    std::atomic<Bitboard> data;
+  };
+
+  struct alignas(64) Bucket
+  {
+    Slot slots [ENTRIES_PER_BUCKET];
+  };
+
+  Bucket*buckets;
+  long long bucketCount;
+  int megabytes;
+  std::atomic<int> age; //read by every search thread, bumped by the main one
+
+  /*
+   * data layout:
+   * bits 0-15 move, 16-31 score, 32-47 static eval, 48-55 depth + DEPTH_OFFSET,
+   * 56-57 bound, 58-63 age. a depth byte of zero means the slot is empty.
+   */
+  enum
+  {
+    DEPTH_OFFSET = 8,
+    AGE_MASK = 63
+  };
+
+  Bucket&bucketFor (Bitboard key)
+  {
+    /*the high half of key * bucketCount spreads keys over any table size*/
+#if defined(__SIZEOF_INT128__)
+    return buckets [(long long) (((unsigned __int128) key * (unsigned __int128) bucketCount) >> 64)];
+#else
+    Bitboard count = (Bitboard) bucketCount;
+    Bitboard a = key >> 32, b = key & 0xFFFFFFFF, c = count >> 32, d = count & 0xFFFFFFFF;
+    Bitboard mid = (b * d >> 32) + (a * d & 0xFFFFFFFF) + (b * c & 0xFFFFFFFF);
+    return buckets [(long long) (a * c + (a * d >> 32) + (b * c >> 32) + (mid >> 32))];
+#endif
+  }
+
+  static int unpackDepth (Bitboard data)
+  {
+    return (int) ((data >> 48) & 0xFF) - DEPTH_OFFSET;
+  }
+
+  static int unpackAge (Bitboard data)
+  {
+    return (int) (data >> 58);
+  }
+
+  void allocate (int megabytes);
+  void release ();
+};
+
+#endif // TranspositionTable_h
@@ -0,0 +1,49 @@
+#include <mutex>
+#include "Zobrist.h"
+
+Bitboard Zobrist::pieceKeys [12][64];
+Bitboard Zobrist::castlingKeys [16];
+Bitboard Zobrist::enPassantKeys [8];
+Bitboard Zobrist::sideKey;
+
+/*
+ * fill the keys from a fixed seed so keys, and anything saved that depends on them,
+ * are the same from run to run. safe to call more than once.
+ */
+
+void Zobrist::init ()
+{
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    /*splitmix64*/
+    Bitboard state = 0x2545F4914F6CDD1DULL;
+    auto next = [&state] ()
+    {
+      Bitboard z = (state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    };
+
+    for (int p = 0; p < 12; p++)
+      for (int s = 0; s < 64; s++)
+        pieceKeys [p][s] = next ();
+
+    /*castling keys are per combination, the single rights xor together to make the rest*/
+    Bitboard single [4];
+    for (int i = 0; i < 4; i++)
+      single [i] = next ();
+    for (int rights = 0; rights < 16; rights++)
+    {
+      castlingKeys [rights] = 0;
+      for (int i = 0; i < 4; i++)
+        if (rights & (1 << i))
+          castlingKeys [rights] ^= single [i];
+    }
+
+    for (int f = 0; f < 8; f++)
+      enPassantKeys [f] = next ();
+    sideKey = next ();
+  });
+}
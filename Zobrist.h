@@ -0,0 +1,45 @@
+#ifndef Zobrist_h
+#define Zobrist_h
+
+#include "Bitboard.h"
+
+/*
+ * random keys for Zobrist hashing. a position's key is the xor of the keys for each piece
+ * on its square, the castling rights, the en passant file (if there's an en passant square)
+ * and the side key if black is to move. since xor undoes itself, a move only has to xor in
+ * and out the few keys it changes.
+ */
+
+class Zobrist
+{
+  public:
+  static void init ();
+
+  static Bitboard piece (int piece, int square)
+  {
+    return pieceKeys [piece][square];
+  }
+
+  static Bitboard castling (int rights)
+  {
+    return castlingKeys [rights];
+  }
+
+  static Bitboard enPassant (int square)
+  {
+    return enPassantKeys [square % 8];
+  }
+
+  static Bitboard side ()
+  {
+    return sideKey;
+  }
+
+  private:
+  static Bitboard pieceKeys [12][64];
+  static Bitboard castlingKeys [16];
+  static Bitboard enPassantKeys [8];
+  static Bitboard sideKey;
+};
+
+#endif // Zobrist_h
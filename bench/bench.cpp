@@ -0,0 +1,227 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include "PieceList.h"
+#include "Attacks.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "Search.h"
+#include "EnginePool.h"
+#include "TranspositionTable.h"
+#include "insist.h"
+
+/*
+ * bench measures how the lazy smp search scales. every position is searched to the same
+ * depth, from an empty hash table, with 1 thread, then 2, 4 and so on up to the number of
+ * cores. for each thread count it prints the total nodes/second and the time to reach the
+ * depth, both relative to one thread.
+ *
+ * nodes/second should scale close to linearly. time to depth scales less well, helpers
+ * search some of the same tree and lazy smp gets its strength partly from searching wider.
+ *
+ * bench --eval times the evaluation on its own instead, in evals/second, with each batch
+ * kernel the CPU can run (see Evaluator.h). the positions are everything two plies from the
+ * bench positions, evaluated over and over, so the pawn table is warm as it is in a search.
+ *
+ * usage:
+ *   bench [--depth=N] [--threads=N] [--hash=MB]
+ *   bench --eval [--seconds=N]
+ */
+
+static std::vector<std::string>positions =
+{
+  "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+  "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+  "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+  "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8",
+  "8/8/1p4k1/1P1K2p1/8/6P1/8/8 w - - 0 1",
+  "2r3k1/1q1nbppp/r3p3/3pP3/pPpP4/P1Q2N2/2RN1PPP/2R4K b - - 0 23",
+  "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1"
+};
+
+static bool option (std::string arg, std::string name, std::string&value)
+{
+  std::string prefix = "--" + name + "=";
+  if (arg.compare (0, prefix.size (), prefix) != 0)
+    return false;
+  value = arg.substr (prefix.size ());
+  return true;
+}
+
+/*
+ * the positions ply plies down from position, into leaves
+ */
+
+static void collect (PieceList&position, int ply, std::vector<PieceList>&leaves)
+{
+  if (ply == 0)
+  {
+    leaves.push_back (position);
+    return;
+  }
+
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+  for (Move move : moves)
+  {
+    position.makeMove (move);
+    collect (position, ply - 1, leaves);
+    position.unmakeMove ();
+  }
+}
+
+static void benchEval (double seconds)
+{
+  std::vector<PieceList>leaves;
+  for (std::string&fen : positions)
+  {
+    PieceList position;
+    insist (position.setFen (fen));
+    collect (position, 2, leaves);
+  }
+
+  std::cout << leaves.size () << " positions" << std::endl;
+  std::cout << std::setw (8) << "kernel" << std::setw (14) << "evals" << std::setw (10) << "seconds"
+            << std::setw (14) << "evals/s" << std::endl;
+
+  Evaluator::Kernel best = Evaluator::getKernel ();
+  long long expected = 0;
+  for (int k = Evaluator::Generic; k <= Evaluator::Avx2; k++)
+  {
+    if (!Evaluator::setKernel ((Evaluator::Kernel) k))
+      continue;
+
+    /*the kernels all have to come to the same answers*/
+    Evaluator evaluator;
+    long long sum = 0;
+    for (PieceList&position : leaves)
+      sum += evaluator.evaluate (position);
+    if (k == Evaluator::Generic)
+      expected = sum;
+    insist (sum == expected);
+
+    long long evals = 0;
+    double elapsed = 0;
+    auto start = std::chrono::steady_clock::now ();
+    while (elapsed < seconds)
+    {
+      for (PieceList&position : leaves)
+        sum += evaluator.evaluate (position);
+      evals += leaves.size ();
+      elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    }
+
+    std::cout << std::setw (8) << Evaluator::getKernelName ((Evaluator::Kernel) k) << std::setw (14) << evals
+              << std::setw (10) << std::fixed << std::setprecision (2) << elapsed
+              << std::setw (14) << (long long) (evals / elapsed) << (k == best ? "  (default)" : "")
+              << std::endl;
+  }
+  Evaluator::setKernel (best);
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    int depth = 12;
+    int maxThreads = (int) std::thread::hardware_concurrency ();
+    int hash = 256;
+    bool eval = false;
+    double seconds = 2;
+    if (maxThreads < 1)
+      maxThreads = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+      std::string arg = argv [i], value;
+      if (option (arg, "depth", value))
+        depth = std::stoi (value);
+      else if (option (arg, "threads", value))
+        maxThreads = std::stoi (value);
+      else if (option (arg, "hash", value))
+        hash = std::stoi (value);
+      else if (option (arg, "seconds", value))
+        seconds = std::stod (value);
+      else if (arg == "--eval")
+        eval = true;
+      else
+      {
+        std::cerr << "usage: bench [--depth=N] [--threads=N] [--hash=MB]" << std::endl;
+        std::cerr << "       bench --eval [--seconds=N]" << std::endl;
+        return 2;
+      }
+    }
+
+    Attacks::init ();
+    if (eval)
+    {
+      benchEval (seconds);
+      return 0;
+    }
+    TranspositionTable tt (hash);
+    Search main (&tt, 0);
+    std::vector<Search*>helpers;
+    main.setHelpers (&helpers);
+    EnginePool pool (1);
+
+    std::vector<int>counts;
+    for (int n = 1; n < maxThreads; n *= 2)
+      counts.push_back (n);
+    counts.push_back (maxThreads);
+
+    double baseNps = 0, baseSeconds = 0;
+    std::cout << "depth " << depth << ", " << positions.size () << " positions, " << hash << "MB hash" << std::endl;
+    std::cout << std::setw (8) << "threads" << std::setw (14) << "nodes" << std::setw (10) << "seconds"
+              << std::setw (14) << "nps" << std::setw (10) << "nps x" << std::setw (10) << "ttd x" << std::endl;
+
+    for (int threads : counts)
+    {
+      /*the counts only go up, so the helpers only ever need adding to*/
+      while ((int) helpers.size () + 1 < threads)
+        helpers.push_back (new Search (&tt, (int) helpers.size () + 1));
+      pool.setThreadCount (threads);
+      long long nodes = 0;
+      double seconds = 0;
+
+      for (std::string&fen : positions)
+      {
+        PieceList position;
+        insist (position.setFen (fen));
+        tt.clear ();
+
+        Search::Limits limits;
+        limits.depth = depth;
+        auto start = std::chrono::steady_clock::now ();
+        pool.think (&main, helpers, position, limits);
+        seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+        nodes += main.getNodes ();
+      }
+
+      double nps = seconds > 0 ? nodes / seconds : 0;
+      if (threads == 1)
+      {
+        baseNps = nps;
+        baseSeconds = seconds;
+      }
+
+      std::cout << std::setw (8) << threads << std::setw (14) << nodes
+                << std::setw (10) << std::fixed << std::setprecision (2) << seconds
+                << std::setw (14) << (long long) nps
+                << std::setw (10) << (baseNps > 0 ? nps / baseNps : 0)
+                << std::setw (10) << (seconds > 0 ? baseSeconds / seconds : 0) << std::endl;
+    }
+
+    for (Search*h : helpers)
+      delete h;
+    return 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# bench: searches a fixed set of positions to a fixed depth with 1, 2, 4...
+# threads and reports how nodes/second and time to depth scale.
+#
+#-------------------------------------------------
+
+TARGET = bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += bench.cpp
@@ -0,0 +1,12 @@
+#-------------------------------------------------
+#
+# link against the chess core library built by core/core.pro
+#
+#-------------------------------------------------
+
+include(engine.pri)
+
+LIBS += -L$$top_builddir/lib -ldrbcore
+
+win32-msvc*: PRE_TARGETDEPS += $$top_builddir/lib/drbcore.lib
+else: PRE_TARGETDEPS += $$top_builddir/lib/libdrbcore.a
@@ -0,0 +1,54 @@
+#-------------------------------------------------
+#
+# drbcore: the chess engine as a static library with no qt in it at all, so it
+# can be built and linked into the command line tools on machines without a display.
+# the app links it too.
+#
+#-------------------------------------------------
+
+TARGET = drbcore
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG -= qt
+DESTDIR = $$top_builddir/lib
+
+include(../engine.pri)
+
+SOURCES += \
+    ../insist.cpp \
+    ../Zobrist.cpp \
+    ../Psqt.cpp \
+    ../PieceList.cpp \
+    ../Attacks.cpp \
+    ../MoveGenerator.cpp \
+    ../Evaluator.cpp \
+    ../TranspositionTable.cpp \
+    ../Search.cpp \
+    ../EnginePool.cpp \
+    ../MappedFile.cpp \
+    ../Book.cpp \
+    ../Tablebases.cpp \
+    ../Pgn.cpp \
+    ../PgnReader.cpp \
+    ../Engine.cpp
+
+HEADERS += \
+    ../insist.h \
+    ../Bitboard.h \
+    ../Zobrist.h \
+    ../Psqt.h \
+    ../PieceList.h \
+    ../Move.h \
+    ../MoveList.h \
+    ../Attacks.h \
+    ../MoveGenerator.h \
+    ../Evaluator.h \
+    ../TranspositionTable.h \
+    ../Search.h \
+    ../EnginePool.h \
+    ../MappedFile.h \
+    ../Book.h \
+    ../Tablebases.h \
+    ../Pgn.h \
+    ../PgnReader.h \
+    ../Engine.h
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# compiler settings for the chess engine proper: the position, move generation
+# and everything else that doesn't need qt. the sources are in core/core.pro,
+# anything that uses the engine includes core.pri instead of this.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CONFIG += c++11 thread
+
+# qmake CONFIG+=pext uses BMI2 pext for slider attacks. only for CPUs that have it
+# (and do it fast, so not AMD before Zen 3). Attacks.h looks at it too, so it has
+# to be the same for the library and everything linking it.
+pext {
+    DEFINES += USE_PEXT
+    QMAKE_CXXFLAGS += -mbmi2
+}
+
+# hotInsist (see insist.h) is compiled out of release builds and in to debug ones.
+# qmake CONFIG+=checked turns it on in any build and makes the position check all of
+# its invariants (key, piece-square score, bitboards against the mailbox) after every
+# makeMove and unmakeMove. that's a lot slower, it's for CI, not for playing.
+CONFIG(debug, debug|release): DEFINES += DRB_HOT_INSIST
+checked {
+    DEFINES += DRB_HOT_INSIST DRB_CHECKED
+}
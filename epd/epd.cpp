@@ -0,0 +1,359 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "PieceList.h"
+#include "MoveGenerator.h"
+#include "Attacks.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "Pgn.h"
+#include "insist.h"
+
+/*
+ * epd runs a test suite: positions in EPD with the move to find (bm) or a move to stay away
+ * from (am), like WAC or the STS suites. each position is searched for a fixed time or node
+ * budget, and it's solved if the move at the end is one of the bm moves, or isn't one of the
+ * am moves.
+ *
+ * the positions are shared out between threads, one search each with a hash table of its own,
+ * so a suite takes about 1/threads as long. each search is single threaded, so the results
+ * don't depend on the thread count (with a node budget they're exactly repeatable).
+ *
+ * time to solution is when the search settled on a right move for good: the start of the
+ * last run of iterations whose best move was right.
+ *
+ * with --min=N the exit status is 1 if fewer than N positions are solved, for builds to fail on.
+ *
+ * usage:
+ *   epd [--time=MS] [--nodes=N] [--threads=N] [--hash=MB] [--min=N] FILE
+ */
+
+struct Test
+{
+  std::string id;
+  std::string fen;
+  std::vector<Move>best; //bm
+  std::vector<Move>avoid; //am
+};
+
+struct Result
+{
+  bool solved;
+  Move move;
+  int solvedAt; //milliseconds, -1 if not solved
+  long long nodes;
+  double seconds;
+};
+
+static bool option (std::string arg, std::string name, std::string&value)
+{
+  std::string prefix = "--" + name + "=";
+  if (arg.compare (0, prefix.size (), prefix) != 0)
+    return false;
+  value = arg.substr (prefix.size ());
+  return true;
+}
+
+/*
+ * a move in an EPD operation, in SAN or, from some suites, in coordinates
+ */
+
+static Move parseMove (PieceList&position, std::string text)
+{
+  Move move = Pgn::fromSan (position, text.c_str (), text.size ());
+  if (!move.isNull ())
+    return move;
+
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+  for (Move m : moves)
+    if (m.toString () == text)
+      return m;
+  return Move ();
+}
+
+/*
+ * one EPD line: the first four FEN fields, then operations like bm Nf3 Qd2; id "WAC.001";
+ * the move clocks come from the hmvc and fmvn operations if they're there. returns false,
+ * with error set, if the line can't be used.
+ */
+
+static bool parseEpd (const std::string&line, Test&test, std::string&error)
+{
+  std::istringstream in (line);
+  std::string fields [4];
+  for (std::string&field : fields)
+    in >> field;
+  if (fields [3].empty ())
+  {
+    error = "not enough fields";
+    return false;
+  }
+
+  std::string rest;
+  std::getline (in, rest);
+
+  /*operations end with ; but a quoted string can have one in it*/
+  std::vector<std::string>operations;
+  std::string operation;
+  bool quoted = false;
+  for (char c : rest)
+  {
+    if (c == '"')
+      quoted = !quoted;
+    if (c == ';' && !quoted)
+    {
+      operations.push_back (operation);
+      operation.clear ();
+    }
+    else
+      operation += c;
+  }
+  operations.push_back (operation);
+
+  std::string halfmoves = "0", fullmoves = "1";
+  std::vector<std::string>best, avoid;
+  for (std::string&op : operations)
+  {
+    std::istringstream words (op);
+    std::string opcode, word;
+    words >> opcode;
+
+    std::vector<std::string>operands;
+    while (words >> word)
+      operands.push_back (word);
+
+    if (opcode == "bm")
+      best.insert (best.end (), operands.begin (), operands.end ());
+    else if (opcode == "am")
+      avoid.insert (avoid.end (), operands.begin (), operands.end ());
+    else if (opcode == "id")
+    {
+      size_t open = op.find ('"'), close = op.rfind ('"');
+      test.id = open != close ? op.substr (open + 1, close - open - 1) : operands.empty () ? "" : operands [0];
+    }
+    else if (opcode == "hmvc" && !operands.empty ())
+      halfmoves = operands [0];
+    else if (opcode == "fmvn" && !operands.empty ())
+      fullmoves = operands [0];
+  }
+
+  test.fen = fields [0] + " " + fields [1] + " " + fields [2] + " " + fields [3] + " " + halfmoves + " " + fullmoves;
+  PieceList position;
+  if (!position.setFen (test.fen))
+  {
+    error = "bad position";
+    return false;
+  }
+
+  for (std::string&text : best)
+  {
+    Move move = parseMove (position, text);
+    if (move.isNull ())
+    {
+      error = "bad move " + text;
+      return false;
+    }
+    test.best.push_back (move);
+  }
+  for (std::string&text : avoid)
+  {
+    Move move = parseMove (position, text);
+    if (move.isNull ())
+    {
+      error = "bad move " + text;
+      return false;
+    }
+    test.avoid.push_back (move);
+  }
+
+  if (test.best.empty () && test.avoid.empty ())
+  {
+    error = "no bm or am";
+    return false;
+  }
+  return true;
+}
+
+static bool isSolution (Test&test, Move move)
+{
+  for (Move m : test.avoid)
+    if (m == move)
+      return false;
+  if (test.best.empty ())
+    return !move.isNull ();
+  for (Move m : test.best)
+    if (m == move)
+      return true;
+  return false;
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    int threads = (int) std::thread::hardware_concurrency ();
+    int hash = 16;
+    int minSolved = 0;
+    std::string path;
+    Search::Limits limits;
+    if (threads < 1)
+      threads = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+      std::string arg = argv [i], value;
+      if (option (arg, "time", value))
+        limits.moveTime = std::stoi (value);
+      else if (option (arg, "nodes", value))
+        limits.nodes = std::stoll (value);
+      else if (option (arg, "threads", value))
+        threads = std::stoi (value);
+      else if (option (arg, "hash", value))
+        hash = std::stoi (value);
+      else if (option (arg, "min", value))
+        minSolved = std::stoi (value);
+      else if (arg.compare (0, 2, "--") != 0 && path.empty ())
+        path = arg;
+      else
+        path.clear (), i = argc;
+    }
+    if (path.empty () || threads < 1 || hash < 1)
+    {
+      std::cerr << "usage: epd [--time=MS] [--nodes=N] [--threads=N] [--hash=MB] [--min=N] FILE" << std::endl;
+      return 2;
+    }
+    if (limits.moveTime <= 0 && limits.nodes <= 0)
+      limits.moveTime = 1000;
+
+    Attacks::init ();
+
+    std::ifstream in (path);
+    if (!in)
+    {
+      std::cerr << "can't open " << path << std::endl;
+      return 1;
+    }
+
+    std::vector<Test>tests;
+    std::string line, error;
+    for (int lineNumber = 1; std::getline (in, line); lineNumber++)
+    {
+      if (line.find_first_not_of (" \t\r") == std::string::npos || line [0] == '#')
+        continue;
+      Test test;
+      if (!parseEpd (line, test, error))
+      {
+        std::cerr << path << ":" << lineNumber << ": " << error << ", skipped" << std::endl;
+        continue;
+      }
+      if (test.id.empty ())
+        test.id = "line " + std::to_string (lineNumber);
+      tests.push_back (test);
+    }
+
+    if (threads > (int) tests.size ())
+      threads = tests.size () > 0 ? (int) tests.size () : 1;
+    std::cout << tests.size () << " positions, " << threads << " threads, ";
+    if (limits.nodes > 0)
+      std::cout << limits.nodes << " nodes";
+    else
+      std::cout << limits.moveTime << "ms";
+    std::cout << " each, " << hash << "MB hash per thread" << std::endl;
+
+    /*the threads take the next position until there are none left*/
+    std::vector<Result>results (tests.size ());
+    std::atomic<size_t> nextTest (0);
+    std::mutex outputMutex;
+    auto start = std::chrono::steady_clock::now ();
+
+    auto work = [&] ()
+    {
+      TranspositionTable tt (hash);
+      Search search (&tt);
+
+      for (size_t i = nextTest++; i < tests.size (); i = nextTest++)
+      {
+        Test&test = tests [i];
+        Result&result = results [i];
+        PieceList position;
+        insist (position.setFen (test.fen));
+        tt.clear ();
+
+        result.solvedAt = -1;
+        auto searchStart = std::chrono::steady_clock::now ();
+        result.move = search.think (position, limits, [&test, &result] (Search::Info&info)
+        {
+          if (info.pv.empty () || !isSolution (test, info.pv [0]))
+            result.solvedAt = -1;
+          else if (result.solvedAt < 0)
+            result.solvedAt = info.time;
+        });
+        result.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - searchStart).count ();
+        result.nodes = search.getNodes ();
+        result.solved = isSolution (test, result.move);
+        if (!result.solved)
+          result.solvedAt = -1;
+        else if (result.solvedAt < 0)
+          result.solvedAt = (int) (result.seconds * 1000);
+
+        std::lock_guard<std::mutex> lock (outputMutex);
+        std::cout << std::setw (5) << i + 1 << "  " << std::left << std::setw (16) << test.id << std::right
+                  << (result.solved ? "  ok  " : "  --  ")
+                  << std::setw (8) << (result.move.isNull () ? "none" : Pgn::toSan (position, result.move));
+        if (result.solved)
+          std::cout << "  " << result.solvedAt << "ms";
+        std::cout << std::endl;
+      }
+    };
+
+    std::vector<std::thread>workers;
+    for (int i = 0; i < threads; i++)
+      workers.push_back (std::thread (work));
+    for (std::thread&t : workers)
+      t.join ();
+    double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+    int solved = 0;
+    long long nodes = 0, solvedTime = 0;
+    double searchSeconds = 0;
+    for (Result&r : results)
+    {
+      nodes += r.nodes;
+      searchSeconds += r.seconds;
+      if (r.solved)
+      {
+        solved++;
+        solvedTime += r.solvedAt;
+      }
+    }
+
+    std::cout << std::endl << "solved " << solved << "/" << tests.size ()
+              << " (" << std::fixed << std::setprecision (1) << (tests.empty () ? 0.0 : 100.0 * solved / tests.size ()) << "%)"
+              << std::endl;
+    if (solved)
+      std::cout << "mean time to solution " << solvedTime / solved << "ms" << std::endl;
+    std::cout << "nodes " << nodes << ", " << std::setprecision (2) << seconds << "s, "
+              << (long long) (seconds > 0 ? nodes / seconds : 0) << " nps, "
+              << (long long) (searchSeconds > 0 ? nodes / searchSeconds : 0) << " nps per thread" << std::endl;
+
+    if (solved < minSolved)
+    {
+      std::cout << "fewer than " << minSolved << " solved" << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
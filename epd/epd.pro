@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# epd: runs an EPD test suite (bm/am positions) with a fixed time or node
+# budget per position and reports how many were solved.
+#
+#-------------------------------------------------
+
+TARGET = epd
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += epd.cpp
@@ -0,0 +1,39 @@
+#-------------------------------------------------
+#
+# the DrB app: the qt front end on top of the core library
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = DrB
+TEMPLATE = app
+
+include(core.pri)
+
+SOURCES += main.cpp \
+    BoardWindow.cpp \
+    Application.cpp \
+    BoardScene.cpp \
+    BoardView.cpp \
+    PieceGraphicsItem.cpp \
+    EngineWorker.cpp \
+    PixmapCache.cpp \
+    StatsPanel.cpp
+
+HEADERS  += \
+    BoardWindow.h \
+    Application.h \
+    BoardScene.h \
+    BoardView.h \
+    PieceGraphicsItem.h \
+    EngineWorker.h \
+    PixmapCache.h \
+    StatsPanel.h
+
+RESOURCES += \
+    resources.qrc
+
+CONFIG += c++11
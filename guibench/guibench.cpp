@@ -0,0 +1,119 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QApplication>
+#include <benchmark/benchmark.h>
+#include "PieceGraphicsItem.h"
+#include "PixmapCache.h"
+#include "insist.h"
+
+/*
+ * guibench is the qt half of the micro-benchmarks (microbench is the engine half): what it
+ * costs to get the piece pixmaps at a size, which is what resizing a board comes down to.
+ * the sizes are piece widths for boards from the smallest window to the biggest.
+ *
+ * a cold size is one PixmapCache doesn't have, so each kind of piece is smooth-scaled again, a warm
+ * one is handed out of the cache. the board benchmarks set the size of all 32 pieces of a game,
+ * what BoardScene does on every resize.
+ *
+ * it runs on qt's offscreen platform unless QT_QPA_PLATFORM says otherwise, so it doesn't need
+ * a display. the options are Google Benchmark's, --benchmark_out=FILE --benchmark_out_format=json
+ * to keep the numbers.
+ *
+ * usage:
+ *   guibench [--benchmark_...]
+ */
+
+static int sizes [] = {40, 64, 90, 112};
+
+enum
+{
+  /*one more size than PixmapCache keeps with no boards open, so going round them always misses*/
+  COLD_SIZES = 5
+};
+
+/*one piece at a size it has to be scaled to*/
+static void scaleCold (benchmark::State&state)
+{
+  int size = (int) state.range (0), i = 0;
+  for (auto _ : state)
+  {
+    QPixmap p = PixmapCache::instance ()->getPixmap (PieceList::wQueen, false, size + i);
+    benchmark::DoNotOptimize (p.cacheKey ());
+    i = (i + 1) % COLD_SIZES;
+  }
+  state.SetItemsProcessed (state.iterations ());
+}
+
+static void scaleWarm (benchmark::State&state)
+{
+  int size = (int) state.range (0);
+  for (auto _ : state)
+  {
+    QPixmap p = PixmapCache::instance ()->getPixmap (PieceList::wQueen, false, size);
+    benchmark::DoNotOptimize (p.cacheKey ());
+  }
+  state.SetItemsProcessed (state.iterations ());
+}
+
+/*
+ * the pieces of the start position resized, to sizes round the cache (cold) or between two
+ * sizes it keeps (warm)
+ */
+
+static void resizeBoard (benchmark::State&state, bool cold)
+{
+  int size = (int) state.range (0);
+  PieceList position;
+  std::vector<PieceGraphicsItem*>items;
+  for (int square = 0; square < 64; square++)
+    if (position.getPiece (square) != PieceList::None)
+      items.push_back (new PieceGraphicsItem (size, square, position.getPiece (square)));
+
+  int i = 0;
+  for (auto _ : state)
+  {
+    i = (i + 1) % (cold ? COLD_SIZES : 2);
+    for (PieceGraphicsItem*item : items)
+      item->setSize (size + i);
+  }
+  state.SetItemsProcessed (state.iterations () * items.size ());
+
+  for (PieceGraphicsItem*item : items)
+    delete item;
+}
+
+static void registerBenchmarks ()
+{
+  for (int size : sizes)
+  {
+    std::string n = std::to_string (size);
+    benchmark::RegisterBenchmark (("PixmapCache/scaleCold/" + n).c_str (), scaleCold)->Arg (size);
+    benchmark::RegisterBenchmark (("PixmapCache/scaleWarm/" + n).c_str (), scaleWarm)->Arg (size);
+    benchmark::RegisterBenchmark (("PieceGraphicsItem/resizeBoardCold/" + n).c_str (), resizeBoard, true)->Arg (size);
+    benchmark::RegisterBenchmark (("PieceGraphicsItem/resizeBoardWarm/" + n).c_str (), resizeBoard, false)->Arg (size);
+  }
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    if (qgetenv ("QT_QPA_PLATFORM").isEmpty ())
+      qputenv ("QT_QPA_PLATFORM", "offscreen");
+    QApplication app (argc, argv);
+
+    registerBenchmarks ();
+    benchmark::Initialize (&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+      return 2;
+    benchmark::RunSpecifiedBenchmarks ();
+    benchmark::Shutdown ();
+    return 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# guibench: Google Benchmark timings of the piece pixmap scaling behind a board
+# resize. the qt counterpart of microbench, built with it (CONFIG+=gbench).
+#
+#-------------------------------------------------
+
+QT += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = guibench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../core.pri)
+
+SOURCES += guibench.cpp \
+    ../PieceGraphicsItem.cpp \
+    ../PixmapCache.cpp
+
+HEADERS += \
+    ../PieceGraphicsItem.h \
+    ../PixmapCache.h
+
+RESOURCES += \
+    ../resources.qrc
+
+LIBS += -lbenchmark
@@ -22,10 +22,23 @@ class InsistException
   char message [MAX_MESSAGE];
 };
 
-#if 1
+/*
+ * insist is always on. it's for arguments and state at the edges: setup calls, files, the
+ * GUI, where a check costs nothing next to the work around it.
+ *
+ * hotInsist is for the hot paths, the board accessors and makeMove/unmakeMove, called millions
+ * of times a second in a search. it's compiled out of release builds (the expression isn't
+ * evaluated, so no side effects in it). debug builds and checked builds (qmake CONFIG+=checked,
+ * see engine.pri) have it on, and a checked build also has the position check its invariants
+ * after every make and unmake.
+ */
+
 #define insist(e) if(!(e)){throw InsistException ("assertion failed %s:%d (%s)", __FILE__, __LINE__, #e);}
+
+#if defined(DRB_HOT_INSIST)
+#define hotInsist(e) insist(e)
 #else
-#define insist(e)((void)(e))
+#define hotInsist(e) ((void) sizeof (e))
 #endif
 
 #endif // insist_h
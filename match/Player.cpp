@@ -0,0 +1,335 @@
+#include <chrono>
+#include <thread>
+#include "Player.h"
+#include "MoveGenerator.h"
+#include "insist.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <csignal>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+BuiltinPlayer::BuiltinPlayer (int hash) : tt (hash), search (&tt)
+{
+}
+
+std::string BuiltinPlayer::getName ()
+{
+  return "DrB";
+}
+
+bool BuiltinPlayer::newGame ()
+{
+  tt.clear ();
+  return true;
+}
+
+Move BuiltinPlayer::go (PieceList&, std::vector<Move>&, PieceList&position, Clock&clock, int)
+{
+  Search::Limits limits;
+  limits.timeLeft = clock.time [position.getSideToMove ()];
+  limits.increment = clock.increment;
+  if (limits.timeLeft < 1)
+    limits.timeLeft = 1;
+  return search.think (position, limits);
+}
+
+UciPlayer::UciPlayer (std::string command) : command (command), name (command), running (false)
+{
+#if defined(_WIN32)
+  process = input = output = 0;
+#else
+  pid = -1;
+  input = output = -1;
+#endif
+}
+
+UciPlayer::~UciPlayer ()
+{
+  if (running)
+  {
+    send ("quit");
+
+    /*give it a moment to go on its own*/
+    for (int i = 0; i < 100; i++)
+    {
+#if defined(_WIN32)
+      if (WaitForSingleObject ((HANDLE) process, 0) == WAIT_OBJECT_0)
+        break;
+#else
+      int status;
+      if (waitpid (pid, &status, WNOHANG) == pid)
+      {
+        pid = -1;
+        break;
+      }
+#endif
+      std::this_thread::sleep_for (std::chrono::milliseconds (10));
+    }
+    kill ();
+  }
+}
+
+std::string UciPlayer::getName ()
+{
+  return name;
+}
+
+/*
+ * run the engine and wait for it to be ready, returns false if it doesn't start or answer
+ */
+
+bool UciPlayer::start ()
+{
+  buffer.clear ();
+
+#if defined(_WIN32)
+  SECURITY_ATTRIBUTES attributes = {sizeof (attributes), 0, TRUE};
+  HANDLE childIn, childOut, in, out;
+  if (!CreatePipe (&childIn, &in, &attributes, 0))
+    return false;
+  if (!CreatePipe (&out, &childOut, &attributes, 0))
+  {
+    CloseHandle (childIn);
+    CloseHandle (in);
+    return false;
+  }
+  SetHandleInformation (in, HANDLE_FLAG_INHERIT, 0);
+  SetHandleInformation (out, HANDLE_FLAG_INHERIT, 0);
+
+  STARTUPINFOA startup = {};
+  startup.cb = sizeof (startup);
+  startup.dwFlags = STARTF_USESTDHANDLES;
+  startup.hStdInput = childIn;
+  startup.hStdOutput = childOut;
+  startup.hStdError = GetStdHandle (STD_ERROR_HANDLE);
+  PROCESS_INFORMATION info;
+  std::vector<char>commandLine (command.begin (), command.end ());
+  commandLine.push_back (0);
+  bool created = CreateProcessA (0, &commandLine [0], 0, 0, TRUE, 0, 0, 0, &startup, &info) != 0;
+  CloseHandle (childIn);
+  CloseHandle (childOut);
+  if (!created)
+  {
+    CloseHandle (in);
+    CloseHandle (out);
+    return false;
+  }
+  CloseHandle (info.hThread);
+  process = info.hProcess;
+  input = in;
+  output = out;
+#else
+  int toChild [2], fromChild [2];
+  if (pipe (toChild) != 0)
+    return false;
+  if (pipe (fromChild) != 0)
+  {
+    ::close (toChild [0]);
+    ::close (toChild [1]);
+    return false;
+  }
+
+  pid = fork ();
+  if (pid == 0)
+  {
+    dup2 (toChild [0], 0);
+    dup2 (fromChild [1], 1);
+    ::close (toChild [0]);
+    ::close (toChild [1]);
+    ::close (fromChild [0]);
+    ::close (fromChild [1]);
+    execl ("/bin/sh", "sh", "-c", command.c_str (), (char*) 0);
+    _exit (127);
+  }
+
+  ::close (toChild [0]);
+  ::close (fromChild [1]);
+  if (pid < 0)
+  {
+    ::close (toChild [1]);
+    ::close (fromChild [0]);
+    return false;
+  }
+  input = toChild [1];
+  output = fromChild [0];
+#endif
+
+  running = true;
+  std::string line;
+  if (!send ("uci"))
+    return false;
+  while (waitFor ("", START_TIMEOUT, &line))
+  {
+    if (line.compare (0, 8, "id name ") == 0)
+      name = line.substr (8);
+    else if (line == "uciok")
+      return true;
+  }
+  kill ();
+  return false;
+}
+
+void UciPlayer::kill ()
+{
+  if (!running)
+    return;
+  running = false;
+
+#if defined(_WIN32)
+  TerminateProcess ((HANDLE) process, 1);
+  CloseHandle ((HANDLE) process);
+  CloseHandle ((HANDLE) input);
+  CloseHandle ((HANDLE) output);
+  process = input = output = 0;
+#else
+  ::close (input);
+  ::close (output);
+  input = output = -1;
+  if (pid > 0)
+  {
+    ::kill (pid, SIGKILL);
+    waitpid (pid, 0, 0);
+  }
+  pid = -1;
+#endif
+}
+
+bool UciPlayer::send (std::string line)
+{
+  if (!running)
+    return false;
+  line += "\n";
+
+#if defined(_WIN32)
+  DWORD written;
+  return WriteFile ((HANDLE) input, line.data (), (DWORD) line.size (), &written, 0) && written == line.size ();
+#else
+  for (size_t done = 0; done < line.size (); )
+  {
+    ssize_t n = write (input, line.data () + done, line.size () - done);
+    if (n <= 0)
+      return false;
+    done += (size_t) n;
+  }
+  return true;
+#endif
+}
+
+/*
+ * the next line from the engine, waiting up to timeout milliseconds for it. returns false on
+ * a timeout or if the engine has gone.
+ */
+
+bool UciPlayer::readLine (std::string&line, int timeout)
+{
+  auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (timeout);
+
+  while (true)
+  {
+    size_t newline = buffer.find ('\n');
+    if (newline != std::string::npos)
+    {
+      line = buffer.substr (0, newline);
+      buffer.erase (0, newline + 1);
+      if (!line.empty () && line [line.size () - 1] == '\r')
+        line.erase (line.size () - 1);
+      return true;
+    }
+
+    int left = (int) std::chrono::duration_cast<std::chrono::milliseconds> (deadline - std::chrono::steady_clock::now ()).count ();
+    if (left <= 0 || !running)
+      return false;
+
+    char data [4096];
+#if defined(_WIN32)
+    DWORD available;
+    if (!PeekNamedPipe ((HANDLE) output, 0, 0, 0, &available, 0))
+      return false;
+    if (available == 0)
+    {
+      Sleep (1);
+      continue;
+    }
+    DWORD n;
+    if (!ReadFile ((HANDLE) output, data, available < sizeof (data) ? available : sizeof (data), &n, 0) || n == 0)
+      return false;
+#else
+    struct pollfd p = {output, POLLIN, 0};
+    if (poll (&p, 1, left) <= 0)
+      continue;
+    ssize_t n = read (output, data, sizeof (data));
+    if (n <= 0)
+      return false;
+#endif
+    buffer.append (data, (size_t) n);
+  }
+}
+
+/*
+ * read lines until one starting with prefix, within timeout milliseconds altogether. an empty
+ * prefix takes any line.
+ */
+
+bool UciPlayer::waitFor (std::string prefix, int timeout, std::string*line)
+{
+  auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (timeout);
+  std::string l;
+
+  while (true)
+  {
+    int left = (int) std::chrono::duration_cast<std::chrono::milliseconds> (deadline - std::chrono::steady_clock::now ()).count ();
+    if (!readLine (l, left > 0 ? left : 0))
+      return false;
+    if (l.compare (0, prefix.size (), prefix) == 0)
+    {
+      if (line)
+        *line = l;
+      return true;
+    }
+  }
+}
+
+bool UciPlayer::newGame ()
+{
+  if (!running && !start ())
+    return false;
+  if (send ("ucinewgame") && send ("isready") && waitFor ("readyok", START_TIMEOUT))
+    return true;
+  kill ();
+  return false;
+}
+
+Move UciPlayer::go (PieceList&start, std::vector<Move>&moves, PieceList&position, Clock&clock, int timeLimit)
+{
+  std::string command = "position fen " + start.getFen ();
+  if (!moves.empty ())
+  {
+    command += " moves";
+    for (Move m : moves)
+      command += " " + m.toString ();
+  }
+
+  std::string line;
+  if (!send (command) ||
+      !send ("go wtime " + std::to_string (clock.time [PieceList::White]) + " btime " + std::to_string (clock.time [PieceList::Black]) +
+             " winc " + std::to_string (clock.increment) + " binc " + std::to_string (clock.increment)) ||
+      !waitFor ("bestmove ", timeLimit, &line))
+  {
+    /*it's still thinking, or gone. either way it can't be trusted with the next game*/
+    kill ();
+    return Move ();
+  }
+
+  std::string text = line.substr (9);
+  text = text.substr (0, text.find (' '));
+  MoveList legal;
+  MoveGenerator::generate (position, legal);
+  for (Move m : legal)
+    if (m.toString () == text)
+      return m;
+  return Move ();
+}
@@ -0,0 +1,96 @@
+#ifndef Player_h
+#define Player_h
+
+#include <string>
+#include <vector>
+#include "PieceList.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+/*
+ * one side in the match runner's games: either the engine built in to the runner, or another
+ * engine run as a UCI process, a different build of this one say, for A/B testing.
+ *
+ * a Player plays one game at a time, and is kept for the next one.
+ */
+
+class Player
+{
+  public:
+  /*the clocks for a move, in milliseconds*/
+  struct Clock
+  {
+    int time [2]; //white's and black's
+    int increment;
+  };
+
+  virtual ~Player () {}
+  virtual std::string getName () = 0;
+  virtual bool newGame () = 0;
+
+  /*
+   * the move in position, which was reached from start by moves. a null move if the player
+   * couldn't come up with one in time (timeLimit milliseconds) or at all.
+   */
+  virtual Move go (PieceList&start, std::vector<Move>&moves, PieceList&position, Clock&clock, int timeLimit) = 0;
+};
+
+/*
+ * the built in engine, single threaded with a hash table of its own
+ */
+
+class BuiltinPlayer : public Player
+{
+  public:
+  BuiltinPlayer (int hash);
+  std::string getName ();
+  bool newGame ();
+  Move go (PieceList&start, std::vector<Move>&moves, PieceList&position, Clock&clock, int timeLimit);
+
+  private:
+  TranspositionTable tt;
+  Search search;
+};
+
+/*
+ * a UCI engine run as a child process, talked to over its standard input and output. if it
+ * dies, hangs or says something that isn't a legal move, go returns a null move and the
+ * next newGame starts it again.
+ */
+
+class UciPlayer : public Player
+{
+  public:
+  UciPlayer (std::string command);
+  ~UciPlayer ();
+  std::string getName ();
+  bool newGame ();
+  Move go (PieceList&start, std::vector<Move>&moves, PieceList&position, Clock&clock, int timeLimit);
+
+  private:
+  enum
+  {
+    START_TIMEOUT = 10000 //milliseconds to answer uci and isready
+  };
+  std::string command;
+  std::string name;
+  std::string buffer; //read but not yet taken as lines
+  bool running;
+#if defined(_WIN32)
+  void*process;
+  void*input;
+  void*output;
+#else
+  int pid;
+  int input; //to the engine
+  int output; //from the engine
+#endif
+
+  bool start ();
+  void kill ();
+  bool send (std::string line);
+  bool readLine (std::string&line, int timeout);
+  bool waitFor (std::string prefix, int timeout, std::string*line = 0);
+};
+
+#endif // Player_h
@@ -0,0 +1,478 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include "PieceList.h"
+#include "MoveGenerator.h"
+#include "Attacks.h"
+#include "Pgn.h"
+#include "PgnReader.h"
+#include "Player.h"
+#include "insist.h"
+#if !defined(_WIN32)
+#include <csignal>
+#endif
+
+/*
+ * match plays games between two engines, lots of them at once, to tell whether a change made
+ * the engine stronger. each engine is either the one built in to match (the default) or a UCI
+ * engine given as a command, usually drb-uci from another build:
+ *
+ *   match --engine2=../old/drb-uci --tc=10+0.1 --openings=book.epd --sprt=0,5 --pgn=games.pgn
+ *
+ * the games run on their own threads, one per core, each engine single threaded, so games/hour
+ * goes up with the cores. every opening (a FEN or EPD line, or the games in a PGN file, played
+ * out) is played twice with the colors swapped. the clock is base+increment in seconds, and
+ * going over it, by more than --margin milliseconds, loses. so does an illegal move.
+ *
+ * after every game the score so far is printed as engine1's wins, losses and draws and the
+ * Elo difference with its 95% error bars. with --sprt=ELO0,ELO1 the match stops as soon as a
+ * sequential probability ratio test can tell an Elo difference of ELO0 from one of ELO1 with
+ * error rates --alpha and --beta, and the exit status is 0 if it came out for ELO1, 1 if for
+ * ELO0 and 3 if the games ran out first. the games are appended to --pgn=FILE as they finish.
+ *
+ * usage:
+ *   match [--engine1=CMD] [--engine2=CMD] [--games=N] [--concurrency=N] [--tc=BASE+INC]
+ *         [--openings=FILE] [--pgn=FILE] [--hash=MB] [--sprt=ELO0,ELO1] [--alpha=A] [--beta=B]
+ *         [--margin=MS]
+ */
+
+struct Opening
+{
+  std::string fen; //empty for the standard start position
+  std::vector<Move>moves; //played from fen to get to the opening
+};
+
+struct Tally
+{
+  int wins;
+  int losses;
+  int draws;
+};
+
+static bool option (std::string arg, std::string name, std::string&value)
+{
+  std::string prefix = "--" + name + "=";
+  if (arg.compare (0, prefix.size (), prefix) != 0)
+    return false;
+  value = arg.substr (prefix.size ());
+  return true;
+}
+
+/*
+ * the openings in path: games in a .pgn file, otherwise one FEN or EPD position a line
+ */
+
+static bool loadOpenings (std::string path, std::vector<Opening>&openings)
+{
+  if (path.size () > 4 && path.compare (path.size () - 4, 4, ".pgn") == 0)
+  {
+    PgnReader reader;
+    if (!reader.open (path))
+      return false;
+    Pgn::Game game;
+    while (reader.next (game))
+      if (game.error.empty ())
+        openings.push_back (Opening {game.getTag ("FEN"), game.moves});
+    return true;
+  }
+
+  std::ifstream in (path);
+  if (!in)
+    return false;
+  std::string line;
+  while (std::getline (in, line))
+  {
+    /*EPD has operations after the four fields, FEN has the clocks*/
+    std::istringstream fields (line);
+    std::string field, fen;
+    for (int i = 0; i < 6 && fields >> field; i++)
+    {
+      if (i >= 4 && field.find_first_not_of ("0123456789") != std::string::npos)
+        break;
+      fen += (i ? " " : "") + field;
+    }
+
+    PieceList position;
+    if (!fen.empty () && position.setFen (fen))
+      openings.push_back (Opening {position.getFen (), std::vector<Move> ()});
+  }
+  return true;
+}
+
+static std::unique_ptr<Player> makePlayer (std::string command, int hash)
+{
+  if (command.empty ())
+    return std::unique_ptr<Player> (new BuiltinPlayer (hash));
+  return std::unique_ptr<Player> (new UciPlayer (command));
+}
+
+/*
+ * a draw the rules call: three times the same position, or nothing left that could mate
+ */
+
+static bool isDrawn (PieceList&position, std::vector<Bitboard>&keys)
+{
+  int repeats = 0;
+  int back = std::min ((int) keys.size (), position.getHalfmoveClock () + 1);
+  for (int i = (int) keys.size () - back; i < (int) keys.size (); i++)
+    repeats += keys [i] == position.getKey ();
+  if (repeats >= 3)
+    return true;
+
+  for (PieceList::Color c : {PieceList::White, PieceList::Black})
+    if (position.getPieces (PieceList::Pawn, c) || position.getPieces (PieceList::Rook, c) || position.getPieces (PieceList::Queen, c))
+      return false;
+  Bitboard minors = 0;
+  for (PieceList::Color c : {PieceList::White, PieceList::Black})
+    minors |= position.getPieces (PieceList::Knight, c) | position.getPieces (PieceList::Bishop, c);
+  return !Bitboards::moreThanOne (minors);
+}
+
+/*
+ * play one game from opening between white and black, filling in game. returns false if
+ * either engine couldn't be got going at all.
+ */
+
+static bool playGame (Opening&opening, Player*white, Player*black, int base, int increment, int margin, Pgn::Game&game)
+{
+  Player*players [2] = {white, black};
+  if (!white->newGame () || !black->newGame ())
+    return false;
+
+  PieceList start, position;
+  game.moves = opening.moves;
+  if (!game.getStart (start))
+    return false;
+  position = start;
+  std::vector<Bitboard>keys (1, position.getKey ());
+  for (Move m : opening.moves)
+  {
+    position.makeMove (m);
+    keys.push_back (position.getKey ());
+  }
+
+  /*the engines are given the position after the opening, with the opening moves on top*/
+  std::vector<Move>played = opening.moves;
+  Player::Clock clock = {{base, base}, increment};
+  std::string termination = "normal";
+
+  while (true)
+  {
+    std::string result = Pgn::getResult (position);
+    if (result == "*" && isDrawn (position, keys))
+      result = "1/2-1/2";
+    if (result != "*")
+    {
+      game.result = result;
+      break;
+    }
+
+    PieceList::Color side = position.getSideToMove ();
+    auto moveStart = std::chrono::steady_clock::now ();
+    Move move = players [side]->go (start, played, position, clock, clock.time [side] + margin);
+    int used = (int) std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now () - moveStart).count ();
+
+    clock.time [side] -= used;
+    if (clock.time [side] < -margin || move.isNull ())
+    {
+      termination = clock.time [side] < -margin ? "time forfeit" : "rules infraction";
+      game.result = side == PieceList::White ? "0-1" : "1-0";
+      break;
+    }
+    clock.time [side] = std::max (clock.time [side], 0) + increment;
+
+    game.moves.push_back (move);
+    played.push_back (move);
+    position.makeMove (move);
+    keys.push_back (position.getKey ());
+  }
+
+  game.setTag ("Result", game.result);
+  game.setTag ("Termination", termination);
+  return true;
+}
+
+/*
+ * Elo difference for a score (0 to 1)
+ */
+
+static double elo (double score)
+{
+  score = std::min (std::max (score, 1e-6), 1 - 1e-6);
+  return 400 * std::log10 (score / (1 - score));
+}
+
+/*
+ * the mean score of a game and its variance, from the wins, losses and draws
+ */
+
+static void meanAndVariance (Tally&s, double&mean, double&variance)
+{
+  double n = s.wins + s.losses + s.draws;
+  mean = (s.wins + 0.5 * s.draws) / n;
+  variance = (s.wins * (1 - mean) * (1 - mean) + s.losses * mean * mean + s.draws * (0.5 - mean) * (0.5 - mean)) / n;
+}
+
+/*
+ * log likelihood ratio of Elo difference elo1 against elo0 for the games so far, using the
+ * normal approximation to the score
+ */
+
+static double llr (Tally&s, double elo0, double elo1)
+{
+  double n = s.wins + s.losses + s.draws;
+  if (n == 0)
+    return 0;
+  double mean, variance;
+  meanAndVariance (s, mean, variance);
+  if (variance <= 0)
+    return 0;
+
+  double s0 = 1 / (1 + std::pow (10, -elo0 / 400)), s1 = 1 / (1 + std::pow (10, -elo1 / 400));
+  return n * (s1 - s0) * (2 * mean - s0 - s1) / (2 * variance);
+}
+
+static void printScore (Tally&s, std::string name1, std::string name2)
+{
+  int n = s.wins + s.losses + s.draws;
+  double mean, variance;
+  meanAndVariance (s, mean, variance);
+  double error = 1.96 * std::sqrt (variance / n);
+  double los = s.wins + s.losses > 0 ? 0.5 * (1 + std::erf ((s.wins - s.losses) / std::sqrt (2.0 * (s.wins + s.losses)))) : 0.5;
+
+  std::cout << "score of " << name1 << " vs " << name2 << ": " << s.wins << " - " << s.losses << " - " << s.draws
+            << " [" << std::fixed << std::setprecision (3) << mean << "] " << n << std::endl;
+  std::cout << "elo difference: " << std::setprecision (1) << elo (mean)
+            << " +/- " << (elo (mean + error) - elo (mean - error)) / 2
+            << ", LOS: " << 100 * los << "%" << std::endl;
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    std::string engines [2], openingsPath, pgnPath;
+    int games = 100;
+    int concurrency = (int) std::thread::hardware_concurrency ();
+    double base = 10, increment = 0.1;
+    int hash = 16;
+    int margin = 100;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+    if (concurrency < 1)
+      concurrency = 1;
+
+    bool usage = false;
+    for (int i = 1; i < argc; i++)
+    {
+      std::string arg = argv [i], value;
+      if (option (arg, "engine1", value))
+        engines [0] = value;
+      else if (option (arg, "engine2", value))
+        engines [1] = value;
+      else if (option (arg, "games", value))
+        games = std::stoi (value);
+      else if (option (arg, "concurrency", value))
+        concurrency = std::stoi (value);
+      else if (option (arg, "tc", value))
+      {
+        size_t plus = value.find ('+');
+        base = std::stod (value.substr (0, plus));
+        increment = plus == std::string::npos ? 0 : std::stod (value.substr (plus + 1));
+      }
+      else if (option (arg, "openings", value))
+        openingsPath = value;
+      else if (option (arg, "pgn", value))
+        pgnPath = value;
+      else if (option (arg, "hash", value))
+        hash = std::stoi (value);
+      else if (option (arg, "sprt", value))
+      {
+        sprt = true;
+        size_t comma = value.find (',');
+        usage |= comma == std::string::npos;
+        elo0 = std::stod (value.substr (0, comma));
+        elo1 = comma == std::string::npos ? 0 : std::stod (value.substr (comma + 1));
+      }
+      else if (option (arg, "alpha", value))
+        alpha = std::stod (value);
+      else if (option (arg, "beta", value))
+        beta = std::stod (value);
+      else if (option (arg, "margin", value))
+        margin = std::stoi (value);
+      else
+        usage = true;
+    }
+    if (usage || games < 1 || concurrency < 1 || base <= 0 || increment < 0 || hash < 1 ||
+        alpha <= 0 || alpha >= 1 || beta <= 0 || beta >= 1 || (sprt && elo1 <= elo0))
+    {
+      std::cerr << "usage: match [--engine1=CMD] [--engine2=CMD] [--games=N] [--concurrency=N] [--tc=BASE+INC]" << std::endl;
+      std::cerr << "             [--openings=FILE] [--pgn=FILE] [--hash=MB] [--sprt=ELO0,ELO1] [--alpha=A] [--beta=B]" << std::endl;
+      std::cerr << "             [--margin=MS]" << std::endl;
+      return 2;
+    }
+
+#if !defined(_WIN32)
+    /*an engine that dies shouldn't take us with it when we write to it*/
+    signal (SIGPIPE, SIG_IGN);
+#endif
+    Attacks::init ();
+
+    std::vector<Opening>openings;
+    if (openingsPath.empty ())
+      openings.push_back (Opening ());
+    else if (!loadOpenings (openingsPath, openings) || openings.empty ())
+    {
+      std::cerr << "no openings in " << openingsPath << std::endl;
+      return 1;
+    }
+
+    std::ofstream pgn;
+    if (!pgnPath.empty ())
+    {
+      pgn.open (pgnPath, std::ios::app);
+      if (!pgn)
+      {
+        std::cerr << "can't write " << pgnPath << std::endl;
+        return 1;
+      }
+    }
+
+    /*the names are only known once the engines are running*/
+    std::string names [2];
+    for (int i = 0; i < 2; i++)
+    {
+      std::unique_ptr<Player> player = makePlayer (engines [i], 1);
+      if (!player->newGame ())
+      {
+        std::cerr << "can't start " << engines [i] << std::endl;
+        return 1;
+      }
+      names [i] = player->getName ();
+    }
+    if (names [0] == names [1])
+      names [1] += " 2";
+
+    char date [16];
+    std::time_t now = std::time (0);
+    std::strftime (date, sizeof (date), "%Y.%m.%d", std::localtime (&now));
+    std::ostringstream timeControl;
+    timeControl << base << "+" << increment;
+
+    concurrency = std::min (concurrency, games);
+    std::cout << games << " games, " << openings.size () << " openings, " << concurrency << " at once, "
+              << timeControl.str () << "s" << std::endl;
+    double lowerBound = std::log (beta / (1 - alpha)), upperBound = std::log ((1 - beta) / alpha);
+    if (sprt)
+      std::cout << "sprt elo0 " << elo0 << " elo1 " << elo1 << ", alpha " << alpha << " beta " << beta
+                << ", bounds " << std::setprecision (2) << std::fixed << lowerBound << " " << upperBound << std::endl;
+
+    /*the threads take the next game until there are none left or the sprt has decided*/
+    std::atomic<int> nextGame (0);
+    std::atomic<bool> finished (false);
+    std::mutex resultMutex;
+    Tally score = {0, 0, 0};
+    int verdict = 3; //exit status
+    bool failed = false;
+    auto start = std::chrono::steady_clock::now ();
+
+    auto work = [&] ()
+    {
+      std::unique_ptr<Player> players [2] = {makePlayer (engines [0], hash), makePlayer (engines [1], hash)};
+
+      for (int i = nextGame++; i < games && !finished; i = nextGame++)
+      {
+        Opening&opening = openings [(i / 2) % openings.size ()];
+        bool firstIsWhite = i % 2 == 0;
+        Pgn::Game game;
+        game.setTag ("Event", "DrB match");
+        game.setTag ("Site", "?");
+        game.setTag ("Date", date);
+        game.setTag ("Round", std::to_string (i + 1));
+        game.setTag ("White", names [firstIsWhite ? 0 : 1]);
+        game.setTag ("Black", names [firstIsWhite ? 1 : 0]);
+        game.setTag ("TimeControl", timeControl.str ());
+        if (!opening.fen.empty ())
+        {
+          game.setTag ("SetUp", "1");
+          game.setTag ("FEN", opening.fen);
+        }
+
+        Player*white = players [firstIsWhite ? 0 : 1].get ();
+        Player*black = players [firstIsWhite ? 1 : 0].get ();
+        bool played = playGame (opening, white, black, (int) (base * 1000), (int) (increment * 1000), margin, game);
+
+        std::lock_guard<std::mutex> lock (resultMutex);
+        if (!played)
+        {
+          std::cerr << "game " << i + 1 << ": an engine didn't start" << std::endl;
+          failed = finished = true;
+          return;
+        }
+        if (finished)
+          continue;
+
+        bool whiteWon = game.result == "1-0", blackWon = game.result == "0-1";
+        if (whiteWon || blackWon)
+          (whiteWon == firstIsWhite ? score.wins : score.losses)++;
+        else
+          score.draws++;
+
+        std::cout << "game " << i + 1 << ": " << game.getTag ("White") << " - " << game.getTag ("Black") << " "
+                  << game.result << " (" << game.getTag ("Termination") << ")" << std::endl;
+        printScore (score, names [0], names [1]);
+
+        if (pgn.is_open ())
+        {
+          Pgn::write (pgn, game);
+          pgn.flush ();
+        }
+
+        if (sprt)
+        {
+          double ratio = llr (score, elo0, elo1);
+          std::cout << "LLR " << std::setprecision (2) << ratio << " (" << lowerBound << ", " << upperBound << ")" << std::endl;
+          if (ratio >= upperBound || ratio <= lowerBound)
+          {
+            verdict = ratio >= upperBound ? 0 : 1;
+            finished = true;
+          }
+        }
+      }
+    };
+
+    std::vector<std::thread>workers;
+    for (int i = 0; i < concurrency; i++)
+      workers.push_back (std::thread (work));
+    for (std::thread&t : workers)
+      t.join ();
+    if (failed)
+      return 1;
+
+    double hours = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () / 3600;
+    int played = score.wins + score.losses + score.draws;
+    std::cout << std::endl;
+    printScore (score, names [0], names [1]);
+    std::cout << played << " games in " << std::setprecision (1) << hours * 60 << " minutes, "
+              << (long long) (played / hours) << " games/hour" << std::endl;
+    if (sprt)
+      std::cout << "sprt: " << (verdict == 0 ? "H1 accepted, elo1" : verdict == 1 ? "H0 accepted, elo0" : "no decision") << std::endl;
+    return sprt ? verdict : 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
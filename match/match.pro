@@ -0,0 +1,16 @@
+#-------------------------------------------------
+#
+# match: plays engine-vs-engine games, many at once, and reports the Elo
+# difference, with an SPRT to stop as soon as it's clear.
+#
+#-------------------------------------------------
+
+TARGET = match
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += match.cpp Player.cpp
+HEADERS += Player.h
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "PieceList.h"
+#include "Attacks.h"
+#include "Zobrist.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "TranspositionTable.h"
+#include "insist.h"
+
+/*
+ * microbench times the primitives everything else is built on, one at a time, with Google
+ * Benchmark: board access, attack lookups, move generation, make/unmake, the Zobrist update,
+ * the evaluation and the hash table. perft and bench say whether the whole got faster, this
+ * says which part did.
+ *
+ * the positions are fixed, so the numbers can be compared across commits and compilers. the
+ * times are per operation (one square, one move, one probe), the items/second counters too.
+ * Google Benchmark's own options pick what runs and how it's written out, for tracking:
+ *
+ *   microbench --benchmark_filter=MoveGenerator --benchmark_out=run.json --benchmark_out_format=json
+ *
+ * the qt side, scaling the piece pixmaps, is in guibench.
+ *
+ * usage:
+ *   microbench [--benchmark_...]
+ */
+
+struct Position
+{
+  const char*name;
+  const char*fen;
+};
+
+/*an opening, a middlegame full of tactics, a quiet middlegame and a pawn endgame*/
+static Position positions [] =
+{
+  {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+  {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+  {"middlegame", "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8"},
+  {"endgame", "8/8/1p4k1/1P1K2p1/8/6P1/8/8 w - - 0 1"}
+};
+
+static PieceList makePosition (const char*fen)
+{
+  PieceList position;
+  insist (position.setFen (fen));
+  return position;
+}
+
+static void getPiece (benchmark::State&state)
+{
+  PieceList position = makePosition (positions [1].fen);
+  for (auto _ : state)
+    for (int square = 0; square < 64; square++)
+      benchmark::DoNotOptimize (position.getPiece (square));
+  state.SetItemsProcessed (state.iterations () * 64);
+}
+
+/*a piece on and off every empty square, the way the GUI edits a board*/
+static void setPiece (benchmark::State&state)
+{
+  PieceList position = makePosition (positions [1].fen);
+  std::vector<int>empty;
+  for (int square = 0; square < 64; square++)
+    if (position.getPiece (square) == PieceList::None)
+      empty.push_back (square);
+
+  for (auto _ : state)
+    for (int square : empty)
+    {
+      position.setPiece (square, PieceList::wKnight);
+      position.setPiece (square, PieceList::None);
+    }
+  state.SetItemsProcessed (state.iterations () * empty.size () * 2);
+}
+
+static void reset (benchmark::State&state)
+{
+  PieceList position;
+  for (auto _ : state)
+  {
+    position.reset ();
+    benchmark::DoNotOptimize (position.getKey ());
+  }
+}
+
+static void setFen (benchmark::State&state, const char*fen)
+{
+  PieceList position;
+  std::string text = fen;
+  for (auto _ : state)
+    benchmark::DoNotOptimize (position.setFen (text));
+}
+
+/*the attacks of one piece type from every square, with the pieces of a real position in the way*/
+template <Bitboard attacks (int, Bitboard)>
+static void sliderAttacks (benchmark::State&state)
+{
+  Bitboard occupied = makePosition (positions [1].fen).getOccupied ();
+  for (auto _ : state)
+    for (int square = 0; square < 64; square++)
+      benchmark::DoNotOptimize (attacks (square, occupied));
+  state.SetItemsProcessed (state.iterations () * 64);
+}
+
+static void knightAttacks (benchmark::State&state)
+{
+  for (auto _ : state)
+    for (int square = 0; square < 64; square++)
+      benchmark::DoNotOptimize (Attacks::knight (square));
+  state.SetItemsProcessed (state.iterations () * 64);
+}
+
+static void generate (benchmark::State&state, const char*fen, MoveGenerator::GenType type)
+{
+  PieceList position = makePosition (fen);
+  MoveList moves;
+  long long generated = 0;
+  for (auto _ : state)
+  {
+    moves.clear ();
+    MoveGenerator::generate (position, moves, type);
+    benchmark::DoNotOptimize (moves.getSize ());
+    generated += moves.getSize ();
+  }
+  state.SetItemsProcessed (generated);
+}
+
+/*every legal move made and unmade, the time is per pair*/
+static void makeUnmake (benchmark::State&state, const char*fen)
+{
+  PieceList position = makePosition (fen);
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+  for (auto _ : state)
+    for (Move m : moves)
+    {
+      position.makeMove (m);
+      benchmark::DoNotOptimize (position.getKey ());
+      position.unmakeMove ();
+    }
+  state.SetItemsProcessed (state.iterations () * moves.getSize ());
+}
+
+/*what makeMove does to the key for a quiet move: the piece off one square, onto another, side to move*/
+static void zobristUpdate (benchmark::State&state)
+{
+  Zobrist::init ();
+  Bitboard key = 0;
+  for (auto _ : state)
+  {
+    for (int from = 0; from < 64; from++)
+      key ^= Zobrist::piece (PieceList::wKnight, from) ^ Zobrist::piece (PieceList::wKnight, 63 - from) ^ Zobrist::side ();
+    benchmark::DoNotOptimize (key);
+  }
+  state.SetItemsProcessed (state.iterations () * 64);
+}
+
+/*the pawn table is warm after the first call, as it mostly is in a search*/
+static void evaluate (benchmark::State&state, const char*fen, Evaluator::Kernel kernel)
+{
+  Evaluator::Kernel old = Evaluator::getKernel ();
+  Evaluator::setKernel (kernel);
+  PieceList position = makePosition (fen);
+  Evaluator evaluator;
+  for (auto _ : state)
+    benchmark::DoNotOptimize (evaluator.evaluate (position));
+  Evaluator::setKernel (old);
+}
+
+/*
+ * random keys through a table of state.range (0) megabytes. small tables stay in the cache,
+ * big ones are what a search really sees. the probes that should hit are of keys stored into
+ * a table filled a quarter of the way, so they aren't replaced.
+ */
+
+enum
+{
+  KEYS = 1 << 20
+};
+
+static size_t keysToFill (int megabytes)
+{
+  size_t slots = (size_t) megabytes * 1024 * 1024 / 16;
+  return std::min (slots / 4, (size_t) KEYS);
+}
+
+static std::vector<Bitboard>randomKeys (unsigned seed)
+{
+  std::mt19937_64 random (seed);
+  std::vector<Bitboard>keys (KEYS);
+  for (Bitboard&key : keys)
+    key = random ();
+  return keys;
+}
+
+static void ttStore (benchmark::State&state)
+{
+  TranspositionTable tt ((int) state.range (0));
+  std::vector<Bitboard>keys = randomKeys (1);
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    tt.store (keys [i], Move (), 10, 5, 8, TranspositionTable::Exact);
+    i = (i + 1) & (KEYS - 1);
+  }
+  state.SetItemsProcessed (state.iterations ());
+}
+
+static void ttProbe (benchmark::State&state, bool hit)
+{
+  TranspositionTable tt ((int) state.range (0));
+  std::vector<Bitboard>keys = randomKeys (1);
+  size_t count = keysToFill ((int) state.range (0));
+  for (size_t i = 0; i < count; i++)
+    tt.store (keys [i], Move (), 10, 5, 8, TranspositionTable::Exact);
+  if (!hit)
+    keys = randomKeys (2);
+
+  TranspositionTable::Entry entry;
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize (tt.probe (keys [i], entry));
+    i = i + 1 < count ? i + 1 : 0;
+  }
+  state.SetItemsProcessed (state.iterations ());
+}
+
+static void registerBenchmarks ()
+{
+  benchmark::RegisterBenchmark ("PieceList/getPiece", getPiece);
+  benchmark::RegisterBenchmark ("PieceList/setPiece", setPiece);
+  benchmark::RegisterBenchmark ("PieceList/reset", reset);
+  for (Position&p : positions)
+    benchmark::RegisterBenchmark ((std::string ("PieceList/setFen/") + p.name).c_str (), setFen, p.fen);
+
+  benchmark::RegisterBenchmark ("Attacks/knight", knightAttacks);
+  benchmark::RegisterBenchmark ("Attacks/bishop", sliderAttacks<Attacks::bishop>);
+  benchmark::RegisterBenchmark ("Attacks/rook", sliderAttacks<Attacks::rook>);
+  benchmark::RegisterBenchmark ("Attacks/queen", sliderAttacks<Attacks::queen>);
+
+  for (Position&p : positions)
+  {
+    benchmark::RegisterBenchmark ((std::string ("MoveGenerator/all/") + p.name).c_str (), generate, p.fen, MoveGenerator::All);
+    benchmark::RegisterBenchmark ((std::string ("MoveGenerator/captures/") + p.name).c_str (), generate, p.fen, MoveGenerator::Captures);
+  }
+  for (Position&p : positions)
+    benchmark::RegisterBenchmark ((std::string ("PieceList/makeUnmake/") + p.name).c_str (), makeUnmake, p.fen);
+  benchmark::RegisterBenchmark ("Zobrist/update", zobristUpdate);
+
+  for (int k = Evaluator::Generic; k <= Evaluator::Avx2; k++)
+  {
+    Evaluator::Kernel kernel = (Evaluator::Kernel) k;
+    if (!Evaluator::isSupported (kernel))
+      continue;
+    for (Position&p : positions)
+      benchmark::RegisterBenchmark ((std::string ("Evaluator/") + Evaluator::getKernelName (kernel) + "/" + p.name).c_str (),
+                                    evaluate, p.fen, kernel);
+  }
+
+  benchmark::RegisterBenchmark ("TranspositionTable/store", ttStore)->Arg (1)->Arg (256);
+  benchmark::RegisterBenchmark ("TranspositionTable/probeHit", ttProbe, true)->Arg (1)->Arg (256);
+  benchmark::RegisterBenchmark ("TranspositionTable/probeMiss", ttProbe, false)->Arg (1)->Arg (256);
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    Attacks::init ();
+    registerBenchmarks ();
+    benchmark::Initialize (&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+      return 2;
+    benchmark::RunSpecifiedBenchmarks ();
+    benchmark::Shutdown ();
+    return 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# microbench: Google Benchmark timings of the engine's primitives (board access,
+# attacks, move generation, make/unmake, evaluation, hash table). needs
+# libbenchmark, so it's only built with qmake CONFIG+=gbench, see DrB.pro.
+#
+#-------------------------------------------------
+
+TARGET = microbench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += microbench.cpp
+
+LIBS += -lbenchmark
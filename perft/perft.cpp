@@ -0,0 +1,215 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "PieceList.h"
+#include "MoveGenerator.h"
+#include "Attacks.h"
+#include "insist.h"
+
+/*
+ * perft walks the legal move tree to a fixed depth and counts the leaves. the counts for
+ * the standard positions are known, so any difference is a move generator bug.
+ *
+ * it runs in two phases. "bulk" counts the moves at the last ply without playing them, which
+ * mostly measures the generator. "full" also plays every leaf move, so the difference between
+ * the two is what making moves costs.
+ *
+ * usage:
+ *   perft                       run the standard suite
+ *   perft --depth=N             limit the suite (or a single position) to depth N
+ *   perft --fen=FEN             count one position, 1..depth
+ *   perft --fen=FEN --divide    count one position at depth, broken down by root move
+ *   perft --full                also run the full (make every leaf) phase
+ */
+
+struct SuitePosition
+{
+  std::string fen;
+  std::vector<long long>counts; //counts [0] is depth 1
+};
+
+/*from the chess programming wiki perft results page*/
+static std::vector<SuitePosition>suite =
+{
+  {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {20, 400, 8902, 197281, 4865609, 119060324}},
+  {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", {48, 2039, 97862, 4085603, 193690690}},
+  {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -", {14, 191, 2812, 43238, 674624, 11030083}},
+  {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", {6, 264, 9467, 422333, 15833292}},
+  {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", {44, 1486, 62379, 2103487, 89941194}},
+  {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", {46, 2079, 89890, 3894594, 164075551}}
+};
+
+static long long perft (PieceList&position, int depth, bool bulk)
+{
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+
+  if (depth == 1 && bulk)
+    return moves.getSize ();
+
+  long long nodes = 0;
+  for (Move move : moves)
+  {
+    position.makeMove (move);
+    nodes += depth == 1 ? 1 : perft (position, depth - 1, bulk);
+    position.unmakeMove ();
+  }
+  return nodes;
+}
+
+static double secondsSince (std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/*
+ * count position at depth and print one line for it. returns the count.
+ */
+
+static long long timedPerft (PieceList&position, int depth, bool bulk, long long expected)
+{
+  auto start = std::chrono::steady_clock::now ();
+  long long nodes = perft (position, depth, bulk);
+  double seconds = secondsSince (start);
+
+  std::cout << "  " << (bulk ? "bulk" : "full") << " depth " << std::setw (2) << depth
+            << std::setw (14) << nodes
+            << std::setw (10) << std::fixed << std::setprecision (3) << seconds << "s"
+            << std::setw (14) << (long long) (seconds > 0 ? nodes / seconds : 0) << " nps";
+  if (expected >= 0)
+    std::cout << (nodes == expected ? "  ok" : "  FAIL expected " + std::to_string (expected));
+  std::cout << std::endl;
+  return nodes;
+}
+
+static void divide (PieceList&position, int depth)
+{
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+
+  long long total = 0;
+  auto start = std::chrono::steady_clock::now ();
+  for (Move move : moves)
+  {
+    position.makeMove (move);
+    long long nodes = depth > 1 ? perft (position, depth - 1, true) : 1;
+    position.unmakeMove ();
+    std::cout << move.toString () << ": " << nodes << std::endl;
+    total += nodes;
+  }
+  double seconds = secondsSince (start);
+  std::cout << std::endl << "moves: " << moves.getSize () << std::endl
+            << "nodes: " << total << std::endl
+            << "time:  " << seconds << "s" << std::endl;
+}
+
+/*
+ * value of a --name=value argument, or "" if arg isn't that argument
+ */
+
+static bool option (std::string arg, std::string name, std::string&value)
+{
+  std::string prefix = "--" + name + "=";
+  if (arg.compare (0, prefix.size (), prefix) != 0)
+    return false;
+  value = arg.substr (prefix.size ());
+  return true;
+}
+
+int main (int argc, char*argv[])
+{
+  try
+  {
+    int depth = 0;
+    bool doDivide = false;
+    bool full = false;
+    std::string fen;
+
+    for (int i = 1; i < argc; i++)
+    {
+      std::string arg = argv [i], value;
+      if (option (arg, "depth", value))
+        depth = std::stoi (value);
+      else if (option (arg, "fen", value))
+        fen = value;
+      else if (arg == "--divide")
+        doDivide = true;
+      else if (arg == "--full")
+        full = true;
+      else
+      {
+        std::cerr << "usage: perft [--depth=N] [--fen=FEN] [--divide] [--full]" << std::endl;
+        return 2;
+      }
+    }
+
+    Attacks::init ();
+
+    if (!fen.empty ())
+    {
+      PieceList position;
+      if (!position.setFen (fen))
+      {
+        std::cerr << "bad fen: " << fen << std::endl;
+        return 2;
+      }
+      if (depth <= 0)
+        depth = 5;
+
+      if (doDivide)
+        divide (position, depth);
+      else
+      {
+        for (int d = 1; d <= depth; d++)
+          timedPerft (position, d, true, -1);
+        if (full)
+          for (int d = 1; d <= depth; d++)
+            timedPerft (position, d, false, -1);
+      }
+      return 0;
+    }
+
+    /*the suite, totals at the end so runs can be compared at a glance*/
+    int failures = 0;
+    long long totalNodes = 0;
+    double totalSeconds = 0;
+    if (depth <= 0)
+      depth = 5;
+
+    for (SuitePosition&s : suite)
+    {
+      PieceList position;
+      insist (position.setFen (s.fen));
+      std::cout << s.fen << std::endl;
+
+      int maxDepth = std::min (depth, (int) s.counts.size ());
+      for (int phase = 0; phase < (full ? 2 : 1); phase++)
+      {
+        for (int d = 1; d <= maxDepth; d++)
+        {
+          auto start = std::chrono::steady_clock::now ();
+          long long nodes = timedPerft (position, d, phase == 0, s.counts [d - 1]);
+          if (phase == 0)
+          {
+            totalNodes += nodes;
+            totalSeconds += secondsSince (start);
+          }
+          if (nodes != s.counts [d - 1])
+            failures++;
+        }
+      }
+    }
+
+    std::cout << std::endl << "total " << totalNodes << " nodes in " << totalSeconds << "s, "
+              << (long long) (totalSeconds > 0 ? totalNodes / totalSeconds : 0) << " nps (bulk)" << std::endl;
+    std::cout << (failures ? std::to_string (failures) + " FAILED" : "all ok") << std::endl;
+    return failures ? 1 : 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
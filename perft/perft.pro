@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# perft: counts the leaf nodes of the move tree to a fixed depth. used to check
+# the move generator against known counts and to time it.
+#
+#-------------------------------------------------
+
+TARGET = perft
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += perft.cpp
@@ -0,0 +1,298 @@
+#include <iostream>
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include "PieceList.h"
+#include "Attacks.h"
+#include "TranspositionTable.h"
+#include "Search.h"
+#include "EnginePool.h"
+#include "insist.h"
+
+/*
+ * pooltest drives the engine thread pool through sequences that have hung it before. a bug here
+ * shows up as a search that never returns, so every check runs under a watchdog and one that
+ * doesn't finish in time is a failure rather than a hang.
+ *
+ * usage:
+ *   pooltest
+ */
+
+enum
+{
+  TIMEOUT = 60 //seconds, far more than any check needs
+};
+
+static const char*middlegame = "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8";
+
+/*a search with lazy smp helpers on a pool of its own, the way uci and bench run*/
+struct Searcher
+{
+  TranspositionTable tt;
+  Search main;
+  std::vector<Search*>helpers;
+  EnginePool pool;
+
+  Searcher () : tt (16), main (&tt, 0), pool (1)
+  {
+    main.setHelpers (&helpers);
+  }
+
+  ~Searcher ()
+  {
+    for (Search*h : helpers)
+      delete h;
+  }
+
+  void setThreads (int threads)
+  {
+    while ((int) helpers.size () + 1 > threads)
+    {
+      delete helpers.back ();
+      helpers.pop_back ();
+    }
+    while ((int) helpers.size () + 1 < threads)
+      helpers.push_back (new Search (&tt, (int) helpers.size () + 1));
+    pool.setThreadCount (threads);
+  }
+
+  Move think (const char*fen, Search::Limits limits)
+  {
+    PieceList position;
+    insist (position.setFen (fen));
+    return pool.think (&main, helpers, position, limits);
+  }
+};
+
+/*
+ * workers started after a search used to think they hadn't seen it yet and searched it again,
+ * so the next search waited for helpers that weren't listening.
+ */
+
+static bool threadsAfterSearch ()
+{
+  Searcher s;
+  Search::Limits limits;
+  limits.depth = 6;
+  for (int threads : {1, 2, 4, 2, 1, 3})
+  {
+    s.setThreads (threads);
+    if (s.think (middlegame, limits).isNull ())
+      return false;
+  }
+  return true;
+}
+
+/*
+ * a stop that came before the search thread got going used to be cleared by the search as it
+ * started, so go infinite then stop never came back, and a stopped ponder search waited out
+ * its time.
+ */
+
+static bool stopBeforeSearch ()
+{
+  Searcher s;
+  s.setThreads (2);
+  Search::Limits limits;
+  limits.infinite = true;
+
+  s.main.clearStop ();
+  s.pool.stop (&s.main);
+  if (s.think (middlegame, limits).isNull ())
+    return false;
+
+  limits.infinite = false;
+  limits.moveTime = TIMEOUT * 1000;
+  s.main.clearStop ();
+  s.main.setPondering (true);
+  s.pool.stop (&s.main);
+  return !s.think (middlegame, limits).isNull ();
+}
+
+/*
+ * a ponder search with the pool to itself searches with every thread, and after a ponderhit
+ * it's an ordinary search that stops on time
+ */
+
+static bool ponderhit ()
+{
+  Searcher s;
+  s.setThreads (3);
+  Search::Limits limits;
+  limits.moveTime = 200;
+
+  s.main.clearStop ();
+  s.main.setPondering (true);
+  std::future<Move> move = std::async (std::launch::async, [&s, limits] () { return s.think (middlegame, limits); });
+  std::this_thread::sleep_for (std::chrono::milliseconds (100));
+  s.pool.ponderhit (&s.main);
+  return !move.get ().isNull ();
+}
+
+/*
+ * helpers that got to the end of their depth used to be lent a thread again straight away and
+ * start over from depth 1, round and round until the main search was done. a ponder search
+ * holds on at its depth, which leaves plenty of time for it: the trace would show helpers'
+ * iterations starting right up to the stop, rather than only at the beginning.
+ */
+
+static bool finishedHelpers ()
+{
+  Searcher s;
+  s.setThreads (3);
+  s.main.setTracing (true);
+  for (Search*h : s.helpers)
+    h->setTracing (true);
+  Search::Limits limits;
+  limits.depth = 4;
+
+  s.main.clearStop ();
+  s.main.setPondering (true);
+  std::future<Move> move = std::async (std::launch::async, [&s, limits] () { return s.think (middlegame, limits); });
+  std::this_thread::sleep_for (std::chrono::milliseconds (1000));
+  s.pool.stop (&s.main);
+  if (move.get ().isNull ())
+    return false;
+
+  /*every iteration's start, in microseconds from the main search's*/
+  std::ostringstream trace;
+  Search::writeTrace (trace, &s.main);
+  std::string text = trace.str ();
+  for (size_t i = text.find ("\"ts\":"); i != std::string::npos; i = text.find ("\"ts\":", i + 1))
+    if (std::atoll (text.c_str () + i + 5) > 500000)
+      return false;
+  return true;
+}
+
+/*
+ * a helper taken off a search to make room for another, then put back on when that's done, used
+ * to start its counts over, so the node count went back and the first run's stats were lost
+ */
+
+static bool resumedHelper ()
+{
+  EnginePool pool (2);
+  TranspositionTable tt (16);
+  Search first (&tt, 0), second (&tt, 0);
+  std::vector<Search*>helpers (1, new Search (&tt, 1)), none;
+  first.setHelpers (&helpers);
+
+  Search::Limits infinite;
+  infinite.infinite = true;
+  PieceList position;
+  insist (position.setFen (middlegame));
+
+  first.clearStop ();
+  std::future<Move> move = std::async (std::launch::async, [&] () { return pool.think (&first, helpers, position, infinite); });
+  std::this_thread::sleep_for (std::chrono::milliseconds (200));
+
+  /*second takes the helper's thread for a while, then gives it back*/
+  Search::Limits limits;
+  limits.moveTime = 300;
+  second.clearStop ();
+  std::future<Move> other = std::async (std::launch::async, [&] () { return pool.think (&second, none, position, limits); });
+
+  bool ok = true;
+  long long last = 0;
+  for (int i = 0; i < 100; i++)
+  {
+    long long nodes = first.getNodes ();
+    ok = ok && nodes >= last;
+    last = nodes;
+    std::this_thread::sleep_for (std::chrono::milliseconds (10));
+  }
+  bool moved = !other.get ().isNull ();
+  pool.stop (&first);
+  moved = !move.get ().isNull () && moved;
+  delete helpers [0];
+  return ok && moved;
+}
+
+/*
+ * a ponder search stopped to make room for a real one used to come back with the move it had
+ * then, and if the human played the expected move before that move got through, it was played.
+ * now it starts over once the real search is done, and comes back only after the ponderhit.
+ */
+
+static bool preemptedPonder ()
+{
+  EnginePool pool (1);
+  TranspositionTable tt (16);
+  Search pondering (&tt, 0), real (&tt, 0);
+  std::vector<Search*>none;
+  PieceList position;
+  insist (position.setFen (middlegame));
+
+  Search::Limits limits;
+  limits.moveTime = 200;
+  int depth = 0;
+  pondering.clearStop ();
+  pondering.setPondering (true);
+  std::future<Move> move = std::async (std::launch::async, [&] ()
+  {
+    return pool.think (&pondering, none, position, limits, [&depth] (Search::Info&i) { depth = i.depth; });
+  });
+  std::this_thread::sleep_for (std::chrono::milliseconds (100));
+
+  Search::Limits shallow;
+  shallow.depth = 4;
+  real.clearStop ();
+  bool ok = !pool.think (&real, none, position, shallow).isNull ();
+
+  /*still pondering, on the thread the real search has given back*/
+  std::this_thread::sleep_for (std::chrono::milliseconds (100));
+  ok = ok && move.wait_for (std::chrono::seconds (0)) != std::future_status::ready;
+
+  pool.ponderhit (&pondering);
+  return !move.get ().isNull () && ok && depth > 1;
+}
+
+struct Check
+{
+  const char*name;
+  bool (*run) ();
+};
+
+static Check checks [] =
+{
+  {"thread count changed after a search", threadsAfterSearch},
+  {"stop before the search starts", stopBeforeSearch},
+  {"ponderhit", ponderhit},
+  {"finished helpers stay finished", finishedHelpers},
+  {"helper put back on a search keeps its counts", resumedHelper},
+  {"ponder search stopped for a real one", preemptedPonder}
+};
+
+int main ()
+{
+  try
+  {
+    Attacks::init ();
+    int failures = 0;
+    for (Check&check : checks)
+    {
+      std::cout << check.name << std::flush;
+      std::future<bool> result = std::async (std::launch::async, check.run);
+      if (result.wait_for (std::chrono::seconds (TIMEOUT)) != std::future_status::ready)
+      {
+        /*the check's threads are stuck, there's no joining them*/
+        std::cout << "  FAIL hung" << std::endl;
+        std::_Exit (1);
+      }
+      bool ok = result.get ();
+      std::cout << (ok ? "  ok" : "  FAIL") << std::endl;
+      failures += !ok;
+    }
+    std::cout << (failures ? std::to_string (failures) + " FAILED" : "all ok") << std::endl;
+    return failures ? 1 : 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cout << e.getMessage () << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,15 @@
+#-------------------------------------------------
+#
+# pooltest: runs the engine thread pool through the sequences that have hung
+# it before, and fails instead of hanging if one does again.
+#
+#-------------------------------------------------
+
+TARGET = pooltest
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += pooltest.cpp
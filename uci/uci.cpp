@@ -0,0 +1,439 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include "PieceList.h"
+#include "MoveGenerator.h"
+#include "Attacks.h"
+#include "Search.h"
+#include "EnginePool.h"
+#include "TranspositionTable.h"
+#include "Book.h"
+#include "Tablebases.h"
+#include "insist.h"
+
+/*
+ * drb-uci speaks the UCI protocol on stdin/stdout, so the engine can be run by tournament
+ * managers and chess GUIs.
+ *
+ * commands are read on the main thread and searches run on a thread of their own, so the
+ * reader is never stuck behind a search: stop and ponderhit go straight to the search, which
+ * looks at its stop flag on every node. info lines are written by the search thread as each
+ * iteration finishes, and the bestmove when the search is over.
+ *
+ * with Search Stats on, the counts from all the threads (see Search::Stats) come as an info
+ * string just before the bestmove. with a Trace File, every search is written to it as a
+ * Chrome trace after the bestmove, replacing the last one.
+ *
+ * supported: uci, isready, setoption (Hash, Threads, Ponder, OwnBook, Book File, Book Keys, SyzygyPath,
+ * Search Stats, Trace File),
+ * ucinewgame, position, go (wtime btime winc binc movestogo depth nodes movetime infinite ponder), stop, ponderhit, quit.
+ */
+
+class Uci
+{
+  public:
+  Uci ();
+  ~Uci ();
+  void run ();
+
+  private:
+  enum
+  {
+    MAX_HASH = 65536, //megabytes
+    MAX_THREADS = 256
+  };
+
+  TranspositionTable tt;
+  Search main;
+  std::vector<Search*>helpers; //main's lazy smp helpers, one fewer than the Threads option
+  EnginePool pool; //our own, with a thread for main and each helper
+  PieceList position;
+  std::thread searcher;
+  std::mutex outputMutex; //the search thread writes too
+  std::shared_ptr<Book> book;
+  bool ownBook;
+  bool searchStats;
+  std::string traceFile;
+
+  void send (const std::string&line);
+  void stopSearch ();
+  void setThreads (int threads);
+  void setTracing (bool tracing);
+  void setOption (std::istringstream&in);
+  void setPosition (std::istringstream&in);
+  void go (std::istringstream&in);
+  void info (Search::Info&info);
+  Move parseMove (const std::string&text);
+};
+
+Uci::Uci () : main (&tt, 0), pool (1), ownBook (false), searchStats (false)
+{
+  main.setHelpers (&helpers);
+  position.reset ();
+}
+
+Uci::~Uci ()
+{
+  stopSearch ();
+  setThreads (1);
+}
+
+void Uci::send (const std::string&line)
+{
+  std::lock_guard<std::mutex> lock (outputMutex);
+  std::cout << line << std::endl;
+}
+
+/*
+ * stop the search thread, if there is one, and wait for it to be done. the search has to be
+ * finished before anything it uses is changed. it's stopped first because under go infinite or
+ * go ponder it wouldn't finish otherwise, and some GUIs send position or ucinewgame before stop.
+ * it still sends its bestmove.
+ */
+
+void Uci::stopSearch ()
+{
+  if (searcher.joinable ())
+  {
+    pool.stop (&main);
+    searcher.join ();
+  }
+}
+
+/*
+ * search with threads threads, main included. not during a search.
+ */
+
+void Uci::setThreads (int threads)
+{
+  while ((int) helpers.size () + 1 > threads)
+  {
+    delete helpers.back ();
+    helpers.pop_back ();
+  }
+  while ((int) helpers.size () + 1 < threads)
+  {
+    helpers.push_back (new Search (&tt, (int) helpers.size () + 1));
+    helpers.back ()->setTracing (!traceFile.empty ());
+  }
+  pool.setThreadCount (threads);
+}
+
+/*
+ * keep every thread's iterations for Search::writeTrace. not during a search.
+ */
+
+void Uci::setTracing (bool tracing)
+{
+  main.setTracing (tracing);
+  for (Search*h : helpers)
+    h->setTracing (tracing);
+}
+
+/*
+ * the legal move in position with UCI notation text, or a null move if there isn't one
+ */
+
+Move Uci::parseMove (const std::string&text)
+{
+  MoveList moves;
+  MoveGenerator::generate (position, moves);
+  for (Move move : moves)
+    if (move.toString () == text)
+      return move;
+  return Move ();
+}
+
+/*
+ * setoption name <name> value <value>
+ */
+
+void Uci::setOption (std::istringstream&in)
+{
+  std::string token, name, value;
+
+  in >> token; //name
+  while (in >> token && token != "value")
+    name += (name.empty () ? "" : " ") + token;
+  while (in >> token)
+    value += (value.empty () ? "" : " ") + token;
+  if (value == "<empty>")
+    value.clear ();
+
+  if (name == "Hash")
+  {
+    int mb = std::atoi (value.c_str ());
+    if (mb >= 1 && mb <= MAX_HASH)
+      tt.resize (mb);
+  }
+  else if (name == "Threads")
+  {
+    int threads = std::atoi (value.c_str ());
+    if (threads >= 1 && threads <= MAX_THREADS)
+      setThreads (threads);
+  }
+  else if (name == "Ponder")
+    ; //nothing to do, the GUI decides when to ponder
+  else if (name == "OwnBook")
+    ownBook = value == "true";
+  else if (name == "Book File")
+  {
+    book = value.empty () ? nullptr : Book::open (value);
+    if (!value.empty () && !book)
+      send ("info string can't open book " + value);
+  }
+  else if (name == "Book Keys")
+  {
+    if (!Book::loadKeys (value))
+      send ("info string can't load Polyglot keys from " + value);
+  }
+  else if (name == "SyzygyPath")
+  {
+    Tablebases::init (value);
+    if (!value.empty ())
+      send ("info string found tablebases up to " + std::to_string (Tablebases::getMaxPieces ()) + " pieces");
+  }
+  else if (name == "Search Stats")
+    searchStats = value == "true";
+  else if (name == "Trace File")
+  {
+    traceFile = value;
+    setTracing (!traceFile.empty ());
+  }
+  else
+    send ("info string unknown option " + name);
+}
+
+/*
+ * position [startpos | fen <fen>] [moves <move>...]
+ */
+
+void Uci::setPosition (std::istringstream&in)
+{
+  std::string token, fen;
+
+  in >> token;
+  if (token == "startpos")
+  {
+    position.reset ();
+    in >> token; //moves, if there are any
+  }
+  else if (token == "fen")
+  {
+    while (in >> token && token != "moves")
+      fen += (fen.empty () ? "" : " ") + token;
+    if (!position.setFen (fen))
+    {
+      send ("info string bad fen " + fen);
+      position.reset ();
+      return;
+    }
+  }
+  else
+    return;
+
+  while (in >> token)
+  {
+    Move move = parseMove (token);
+    if (move.isNull ())
+    {
+      send ("info string illegal move " + token);
+      return;
+    }
+    position.makeMove (move);
+  }
+}
+
+/*
+ * an info line for a finished iteration. scores are centipawns, or moves to mate.
+ */
+
+void Uci::info (Search::Info&info)
+{
+  std::ostringstream line;
+  line << "info depth " << info.depth << " seldepth " << info.selectiveDepth << " score ";
+
+  if (info.score >= Search::MATE_IN_MAX_PLY)
+    line << "mate " << (Search::MATE - info.score + 1) / 2;
+  else if (info.score <= -Search::MATE_IN_MAX_PLY)
+    line << "mate " << -(Search::MATE + info.score) / 2;
+  else
+    line << "cp " << info.score;
+
+  line << " nodes " << info.nodes
+       << " nps " << info.nodes * 1000 / (info.time > 0 ? info.time : 1)
+       << " hashfull " << info.hashfull
+       << " time " << info.time
+       << " pv";
+  for (Move m : info.pv)
+    line << " " << m.toString ();
+  send (line.str ());
+}
+
+/*
+ * go [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [depth <n>] [nodes <n>]
+ *    [movetime <ms>] [infinite] [ponder]
+ *
+ * starts the search thread and returns right away.
+ */
+
+void Uci::go (std::istringstream&in)
+{
+  Search::Limits limits;
+  bool ponder = false;
+  bool white = position.getSideToMove () == PieceList::White;
+  std::string token;
+
+  while (in >> token)
+  {
+    if (token == "wtime" || token == "btime")
+    {
+      int time;
+      in >> time;
+      if ((token == "wtime") == white)
+        limits.timeLeft = time > 0 ? time : 1;
+    }
+    else if (token == "winc" || token == "binc")
+    {
+      int increment;
+      in >> increment;
+      if ((token == "winc") == white)
+        limits.increment = increment;
+    }
+    else if (token == "movestogo")
+      in >> limits.movesToGo;
+    else if (token == "depth")
+      in >> limits.depth;
+    else if (token == "nodes")
+      in >> limits.nodes;
+    else if (token == "movetime")
+      in >> limits.moveTime;
+    else if (token == "infinite")
+      limits.infinite = true;
+    else if (token == "ponder")
+      ponder = true;
+  }
+
+  /*a book move goes straight back, unless the GUI wants us thinking until it says stop*/
+  if (ownBook && book && !ponder && !limits.infinite)
+  {
+    Move move = book->probe (position);
+    if (!move.isNull ())
+    {
+      send ("bestmove " + move.toString ());
+      return;
+    }
+  }
+
+  /*set before the thread starts, so a stop or ponderhit right after go can't be missed*/
+  main.clearStop ();
+  main.setPondering (ponder);
+
+  PieceList p = position;
+  searcher = std::thread ([this, p, limits] () mutable
+  {
+    Search::Info last;
+    Move best = pool.think (&main, helpers, p, limits, [this, &last] (Search::Info&i)
+    {
+      last = i;
+      info (i);
+    });
+
+    if (searchStats)
+      send ("info string " + main.getStats ().toString ());
+
+    std::string line = "bestmove " + best.toString ();
+    if (last.pv.size () > 1 && last.pv [0] == best)
+      line += " ponder " + last.pv [1].toString ();
+    send (line);
+
+    if (!traceFile.empty ())
+    {
+      std::ofstream out (traceFile);
+      Search::writeTrace (out, &main);
+      if (!out)
+        send ("info string can't write " + traceFile);
+    }
+  });
+}
+
+void Uci::run ()
+{
+  std::string line;
+
+  while (std::getline (std::cin, line))
+  {
+    std::istringstream in (line);
+    std::string command;
+    in >> command;
+
+    if (command == "uci")
+    {
+      send ("id name DrB");
+      send ("id author finucane");
+      send ("option name Hash type spin default " + std::to_string ((int) TranspositionTable::DEFAULT_SIZE) +
+            " min 1 max " + std::to_string ((int) MAX_HASH));
+      send ("option name Threads type spin default 1 min 1 max " + std::to_string ((int) MAX_THREADS));
+      send ("option name Ponder type check default false");
+      send ("option name OwnBook type check default false");
+      send ("option name Book File type string default <empty>");
+      send ("option name Book Keys type string default <empty>");
+      send ("option name SyzygyPath type string default <empty>");
+      send ("option name Search Stats type check default false");
+      send ("option name Trace File type string default <empty>");
+      send ("uciok");
+    }
+    else if (command == "isready")
+      send ("readyok");
+    else if (command == "stop")
+      pool.stop (&main);
+    else if (command == "ponderhit")
+      pool.ponderhit (&main);
+    else if (command == "quit")
+      break;
+    else if (command == "setoption")
+    {
+      stopSearch ();
+      setOption (in);
+    }
+    else if (command == "ucinewgame")
+    {
+      stopSearch ();
+      tt.clear ();
+    }
+    else if (command == "position")
+    {
+      stopSearch ();
+      setPosition (in);
+    }
+    else if (command == "go")
+    {
+      stopSearch ();
+      go (in);
+    }
+    else if (!command.empty ())
+      send ("info string unknown command " + command);
+  }
+}
+
+int main ()
+{
+  try
+  {
+    std::ios::sync_with_stdio (false);
+    Attacks::init ();
+    Uci uci;
+    uci.run ();
+    return 0;
+  }
+  catch (InsistException&e)
+  {
+    std::cerr << e.getMessage () << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,14 @@
+#-------------------------------------------------
+#
+# uci: the engine as a UCI engine, for tournament managers and chess GUIs
+#
+#-------------------------------------------------
+
+TARGET = drb-uci
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle qt
+
+include(../core.pri)
+
+SOURCES += uci.cpp